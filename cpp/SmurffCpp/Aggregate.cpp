@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+
+#include <SmurffCpp/Aggregate.h>
+
+#include <SmurffCpp/Utils/Error.h>
+#include <SmurffCpp/Utils/SaveState.h>
+
+namespace smurff {
+
+// rows of U per task in add
+static const int aggr_block_rows = 256;
+
+// bytes of sums per chunk, when spilled or saved
+static const std::size_t chunk_bytes = 64 << 20;
+
+// position of element (i, j), j <= i, in a packed lower triangle
+static inline Eigen::Index packed_index(Eigen::Index i, Eigen::Index j)
+{
+   return i * (i + 1) / 2 + j;
+}
+
+Aggregate::Aggregate(AggregateTypes type, int nrows, int num_latent, const std::string &spill_name)
+   : m_type(type), m_nrows(nrows), m_num_latent(num_latent), m_spill_name(spill_name)
+{
+   THROWERROR_ASSERT_MSG(type != AggregateTypes::none, "Aggregate of type none");
+
+   const Eigen::Index row_bytes = (num_latent + dot_cols(type, num_latent)) * sizeof(float_type);
+   m_chunk_rows = std::max(1, std::min(nrows, (int)(chunk_bytes / row_bytes)));
+
+   const int mem_rows = (type == AggregateTypes::spill) ? m_chunk_rows : nrows;
+   m_sum = Matrix::Zero(mem_rows, num_latent);
+   m_dot = Matrix::Zero(mem_rows, dot_cols(type, num_latent));
+
+   if (type == AggregateTypes::spill)
+   {
+      THROWERROR_ASSERT_MSG(!m_spill_name.empty(), "Spilled aggregates need a file name");
+      m_spill.open(m_spill_name, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+      THROWERROR_ASSERT_MSG(m_spill.is_open(), "Could not open " + m_spill_name);
+   }
+}
+
+Aggregate::~Aggregate()
+{
+   if (m_spill.is_open())
+   {
+      m_spill.close();
+      std::remove(m_spill_name.c_str());
+   }
+}
+
+Eigen::Index Aggregate::dot_cols(AggregateTypes type, int num_latent)
+{
+   switch (type)
+   {
+   case AggregateTypes::packed:
+   case AggregateTypes::spill:
+      return (Eigen::Index)num_latent * (num_latent + 1) / 2;
+   case AggregateTypes::diagonal:
+      return num_latent;
+   default:
+      THROWERROR("Invalid aggregate type");
+   }
+}
+
+// the spill file holds all sums of the rows, then all outer products
+void Aggregate::load(int from, int n) const
+{
+   if (m_type != AggregateTypes::spill)
+      return;
+
+   m_chunk_from = from;
+
+   // nothing was written yet
+   if (m_num == 0)
+   {
+      m_sum.setZero();
+      m_dot.setZero();
+      return;
+   }
+
+   const std::streamoff K = m_num_latent, P = m_dot.cols(), s = sizeof(float_type);
+   m_spill.seekg(from * K * s);
+   m_spill.read(reinterpret_cast<char *>(m_sum.data()), n * K * s);
+   m_spill.seekg(m_nrows * K * s + from * P * s);
+   m_spill.read(reinterpret_cast<char *>(m_dot.data()), n * P * s);
+   THROWERROR_ASSERT_MSG(m_spill.good(), "Could not read from " + m_spill_name);
+}
+
+void Aggregate::store(int from, int n) const
+{
+   if (m_type != AggregateTypes::spill)
+      return;
+
+   THROWERROR_ASSERT(from == m_chunk_from);
+
+   const std::streamoff K = m_num_latent, P = m_dot.cols(), s = sizeof(float_type);
+   m_spill.seekp(from * K * s);
+   m_spill.write(reinterpret_cast<const char *>(m_sum.data()), n * K * s);
+   m_spill.seekp(m_nrows * K * s + from * P * s);
+   m_spill.write(reinterpret_cast<const char *>(m_dot.data()), n * P * s);
+   THROWERROR_ASSERT_MSG(m_spill.good(), "Could not write to " + m_spill_name);
+}
+
+void Aggregate::add_rows(const Matrix &U, int from, int to)
+{
+   const int K = m_num_latent;
+   auto sum = sum_rows(from, to - from);
+   auto dot = dot_rows(from, to - from);
+
+   sum += U.middleRows(from, to - from);
+
+   for (int i = 0; i < to - from; i++)
+   {
+      const auto &r = U.row(from + i);
+      if (m_type == AggregateTypes::diagonal)
+      {
+         dot.row(i) += r.array().square().matrix();
+      }
+      else
+      {
+         // row c of the lower triangle is r(c) * r(0..c)
+         float_type *d = dot.row(i).data();
+         for (int c = 0; c < K; c++)
+         {
+            Eigen::Map<Vector>(d, c + 1) += r(c) * r.head(c + 1);
+            d += c + 1;
+         }
+      }
+   }
+}
+
+// after the sweep: one pass over U, split in chunks when spilled and in blocks of rows per task
+void Aggregate::add(const Matrix &U)
+{
+   THROWERROR_ASSERT(U.rows() == m_nrows && U.cols() == m_num_latent);
+
+   for (int from = 0; from < m_nrows; from += m_chunk_rows)
+   {
+      const int n = std::min(m_chunk_rows, m_nrows - from);
+      load(from, n);
+
+      for (int b = from; b < from + n; b += aggr_block_rows)
+      {
+         #pragma omp task shared(U)
+         add_rows(U, b, std::min(b + aggr_block_rows, from + n));
+      }
+      #pragma omp taskwait
+
+      store(from, n);
+   }
+
+   m_num++;
+}
+
+// rows whose sample covariance is singular get a zero precision, their number is returned
+int Aggregate::post(int from, Eigen::Ref<Matrix> mu, Eigen::Ref<Matrix> Lambda, int &first_singular) const
+{
+   const int n = m_num;
+   const int K = m_num_latent;
+   const int nrows = mu.rows();
+   const auto sum = sum_rows(from, nrows);
+   const auto dot = dot_rows(from, nrows);
+
+   mu = sum / n;
+
+   int nsingular = 0;
+   int first = nrows;
+
+   if (n < 2 || (m_type != AggregateTypes::diagonal && n <= K))
+   {
+      // no spread to estimate from one sample, and n samples span at most
+      // n - 1 dimensions: the K x K covariance is singular for every row
+      Lambda.setZero();
+      nsingular = nrows;
+      first = 0;
+   }
+   else if (m_type == AggregateTypes::diagonal)
+   {
+      // precision of each latent on its own
+      #pragma omp parallel for schedule(static) reduction(+:nsingular) reduction(min:first)
+      for (int i = 0; i < nrows; i++)
+      {
+         auto var = (dot.row(i).array() - sum.row(i).array().square() / n) / (n - 1);
+         if ((var > 0).all() && var.isFinite().all())
+         {
+            Lambda.row(i) = var.inverse().matrix();
+         }
+         else
+         {
+            Lambda.row(i).setZero();
+            nsingular++;
+            first = std::min(first, i);
+         }
+      }
+   }
+   else
+   {
+      #pragma omp parallel reduction(+:nsingular) reduction(min:first)
+      {
+         Matrix cov(K, K);
+         Matrix prec(K, K);
+         Eigen::LLT<Matrix> llt(K);
+
+         #pragma omp for schedule(guided)
+         for (int i = 0; i < nrows; i++)
+         {
+            // only the lower triangle, which is all LLT reads
+            const auto &s = sum.row(i);
+            for (int c = 0; c < K; c++)
+               for (int j = 0; j <= c; j++)
+                  cov(c, j) = (dot(i, packed_index(c, j)) - s(c) * s(j) / n) / (n - 1);
+
+            // rounding lets a rank deficient covariance pass LLT about half of the time,
+            // with a tiny pivot; those are singular too
+            llt.compute(cov);
+            const auto pivots = llt.matrixLLT().diagonal();
+            const float_type tiny = K * std::numeric_limits<float_type>::epsilon() * cov.diagonal().maxCoeff();
+            if (llt.info() == Eigen::Success && pivots.allFinite() && pivots.minCoeff() * pivots.minCoeff() >= tiny)
+            {
+               prec.setIdentity();
+               llt.solveInPlace(prec);
+
+               for (int c = 0; c < K; c++)
+                  for (int j = 0; j <= c; j++)
+                     Lambda(i, packed_index(c, j)) = prec(c, j);
+            }
+            else
+            {
+               Lambda.row(i).setZero();
+               nsingular++;
+               first = std::min(first, i);
+            }
+         }
+      }
+   }
+
+   first_singular = from + first;
+   return nsingular;
+}
+
+void Aggregate::full_lambda(AggregateTypes type, int num_latent, const Matrix &Lambda, Matrix &full)
+{
+   const int K = num_latent;
+   THROWERROR_ASSERT(Lambda.cols() == dot_cols(type, K));
+   full.setZero(Lambda.rows(), (Eigen::Index)K * K);
+
+   #pragma omp parallel for schedule(static)
+   for (Eigen::Index i = 0; i < Lambda.rows(); i++)
+      for (int c = 0; c < K; c++)
+      {
+         if (type == AggregateTypes::diagonal)
+         {
+            full(i, c * K + c) = Lambda(i, c);
+            continue;
+         }
+
+         for (int j = 0; j <= c; j++)
+            full(i, c * K + j) = full(i, j * K + c) = Lambda(i, packed_index(c, j));
+      }
+}
+
+void Aggregate::save(SaveState &sf, std::uint64_t mode) const
+{
+   const int K = m_num_latent;
+   const Eigen::Index P = m_dot.cols();
+
+   if (sf.isCheckpoint())
+      sf.createAggr(mode, m_num, m_nrows, K, P);
+   else
+      sf.createPostMuLambda(mode, m_nrows, K, (std::size_t)K * K);
+
+   Matrix mu, Lambda, Lambda_full;
+   int nsingular = 0;
+   int first_singular = m_nrows;
+   for (int from = 0; from < m_nrows; from += m_chunk_rows)
+   {
+      const int n = std::min(m_chunk_rows, m_nrows - from);
+      load(from, n);
+
+      if (sf.isCheckpoint())
+      {
+         sf.putAggr(mode, from, sum_rows(from, n), dot_rows(from, n));
+      }
+      else
+      {
+         mu.resize(n, K);
+         Lambda.resize(n, P);
+         int first;
+         const int ns = post(from, mu, Lambda, first);
+         if (ns && !nsingular) first_singular = first;
+         nsingular += ns;
+         // the same layout as before packed aggregates, and as propagated posteriors expect
+         full_lambda(m_type, K, Lambda, Lambda_full);
+         sf.putPostMuLambda(mode, from, mu, Lambda_full);
+      }
+   }
+
+   if (nsingular)
+   {
+      std::cerr << "warning: post_lambda_" << mode << ": the sample covariance of " << nsingular << " of " << m_nrows
+                << " rows is singular (first: row " << first_singular << " after " << m_num
+                << " samples); their precision is saved as zero" << std::endl;
+   }
+}
+
+void Aggregate::restore(const SaveState &sf, std::uint64_t mode)
+{
+   const int K = m_num_latent;
+   const Eigen::Index P = m_dot.cols();
+
+   int num;
+   std::size_t nrows, file_cols;
+   sf.readAggrInfo(mode, num, nrows, file_cols);
+   THROWERROR_ASSERT_MSG((int)nrows == m_nrows, "Number of rows in aggregate does not match the model");
+
+   // older files keep the full K x K outer product, a packed triangle can become a diagonal
+   const bool full = (Eigen::Index)file_cols == (Eigen::Index)K * K;
+   THROWERROR_ASSERT_MSG((Eigen::Index)file_cols == P || full ||
+                         (m_type == AggregateTypes::diagonal && (Eigen::Index)file_cols == dot_cols(AggregateTypes::packed, K)),
+                         "Cannot restore aggregate with " + std::to_string(file_cols) + " values per row as " + aggregateTypeToString(m_type));
+
+   Matrix file_dot;
+   for (int from = 0; from < m_nrows; from += m_chunk_rows)
+   {
+      const int n = std::min(m_chunk_rows, m_nrows - from);
+      if (m_type == AggregateTypes::spill)
+         m_chunk_from = from;
+
+      auto dot = dot_rows(from, n);
+      if ((Eigen::Index)file_cols == P)
+      {
+         sf.readAggr(mode, from, sum_rows(from, n), dot);
+      }
+      else
+      {
+         file_dot.resize(n, file_cols);
+         sf.readAggr(mode, from, sum_rows(from, n), file_dot);
+
+         for (int i = 0; i < n; i++)
+            for (int c = 0; c < K; c++)
+            {
+               if (m_type == AggregateTypes::diagonal)
+                  dot(i, c) = full ? file_dot(i, c * K + c) : file_dot(i, packed_index(c, c));
+               else
+                  for (int j = 0; j <= c; j++)
+                     dot(i, packed_index(c, j)) = file_dot(i, c * K + j);
+            }
+      }
+
+      store(from, n);
+   }
+
+   m_num = num;
+}
+
+} // end namespace smurff
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <SmurffCpp/Types.h>
+#include <SmurffCpp/Configs/Config.h>
+
+namespace smurff {
+
+class SaveState;
+
+// Sums over the posterior samples of one latent matrix U: of every row, and
+// of the outer product of every row with itself. They give the posterior mean
+// and precision of each row when the model is saved.
+//
+// The outer product is symmetric, depending on the type only part of it is kept:
+//  - packed:   the lower triangle, row by row, K(K+1)/2 values per row
+//  - diagonal: the diagonal, K values per row, post_lambda is diagonal too
+//  - spill:    like packed, but in a file next to the output file, with only
+//              one chunk of rows in memory at a time
+// post_lambda is saved with the full K x K precision of every row in any case.
+class Aggregate
+{
+public:
+   Aggregate(AggregateTypes type, int nrows, int num_latent, const std::string &spill_name = std::string());
+   ~Aggregate();
+
+   Aggregate(const Aggregate &) = delete;
+   Aggregate &operator=(const Aggregate &) = delete;
+
+   // number of values kept per row of the outer product
+   static Eigen::Index dot_cols(AggregateTypes type, int num_latent);
+
+   AggregateTypes type() const { return m_type; }
+   int num() const { return m_num; }
+
+   // adds U as one more sample
+   void add(const Matrix &U);
+
+   // the sums for a checkpoint, post_mu and post_lambda otherwise
+   void save(SaveState &sf, std::uint64_t mode) const;
+   void restore(const SaveState &sf, std::uint64_t mode);
+
+   // posterior mean and precision of rows [from, from + mu.rows()), in parallel over the rows
+   // returns the number of rows with a singular covariance, and the first of them
+   int post(int from, Eigen::Ref<Matrix> mu, Eigen::Ref<Matrix> Lambda, int &first_singular) const;
+
+   // the full K x K precisions, row by row, of the precisions kept as type
+   static void full_lambda(AggregateTypes type, int num_latent, const Matrix &Lambda, Matrix &full);
+
+private:
+   // rows [from, from + n) of the sums, which must be in memory
+   Eigen::Ref<Matrix> sum_rows(int from, int n) const { return m_sum.middleRows(from - m_chunk_from, n); }
+   Eigen::Ref<Matrix> dot_rows(int from, int n) const { return m_dot.middleRows(from - m_chunk_from, n); }
+
+   // brings rows [from, from + n) in memory and writes them back, only does something when spilled
+   void load(int from, int n) const;
+   void store(int from, int n) const;
+
+   void add_rows(const Matrix &U, int from, int to);
+
+private:
+   AggregateTypes m_type;
+   int m_nrows;
+   int m_num_latent;
+   int m_num = 0; // number of samples added
+   int m_chunk_rows; // rows per chunk in load/store and save
+
+   // all rows, or only the chunk starting at m_chunk_from when spilled
+   mutable Matrix m_sum;
+   mutable Matrix m_dot;
+   mutable int m_chunk_from = 0;
+
+   std::string m_spill_name;
+   mutable std::fstream m_spill;
+};
+
+} // end namespace smurff
@@ -46,6 +46,7 @@ static const std::string NUM_THREADS_TAG = "num_threads";
 static const std::string RANDOM_SEED_SET_TAG = "random_seed_set";
 static const std::string RANDOM_SEED_TAG = "random_seed";
 static const std::string INIT_MODEL_TAG = "init_model";
+static const std::string AGGREGATE_TAG = "aggregate";
 static const std::string CLASSIFY_TAG = "classify";
 static const std::string THRESHOLD_TAG = "threshold";
 
@@ -62,6 +63,11 @@ static const std::string PRIOR_NAME_NORMALONE = "normalone";
 static const std::string MODEL_INIT_NAME_RANDOM = "random";
 static const std::string MODEL_INIT_NAME_ZERO = "zero";
 
+static const std::string AGGREGATE_NAME_NONE = "none";
+static const std::string AGGREGATE_NAME_PACKED = "packed";
+static const std::string AGGREGATE_NAME_DIAGONAL = "diagonal";
+static const std::string AGGREGATE_NAME_SPILL = "spill";
+
 PriorTypes stringToPriorType(std::string name)
 {
    if(name == PRIOR_NAME_DEFAULT)
@@ -132,12 +138,48 @@ std::string modelInitTypeToString(ModelInitTypes type)
    }
 }
 
+AggregateTypes stringToAggregateType(std::string name)
+{
+   if(name == AGGREGATE_NAME_NONE)
+      return AggregateTypes::none;
+   else if (name == AGGREGATE_NAME_PACKED)
+      return AggregateTypes::packed;
+   else if (name == AGGREGATE_NAME_DIAGONAL)
+      return AggregateTypes::diagonal;
+   else if (name == AGGREGATE_NAME_SPILL)
+      return AggregateTypes::spill;
+   else
+   {
+      THROWERROR("Invalid aggregate type " + name);
+   }
+}
+
+std::string aggregateTypeToString(AggregateTypes type)
+{
+   switch(type)
+   {
+      case AggregateTypes::none:
+         return AGGREGATE_NAME_NONE;
+      case AggregateTypes::packed:
+         return AGGREGATE_NAME_PACKED;
+      case AggregateTypes::diagonal:
+         return AGGREGATE_NAME_DIAGONAL;
+      case AggregateTypes::spill:
+         return AGGREGATE_NAME_SPILL;
+      default:
+      {
+         THROWERROR("Invalid aggregate type");
+      }
+   }
+}
+
 //config
 int Config::BURNIN_DEFAULT_VALUE = 200;
 int Config::NSAMPLES_DEFAULT_VALUE = 800;
 int Config::NUM_LATENT_DEFAULT_VALUE = 32;
 int Config::NUM_THREADS_DEFAULT_VALUE = 0; // as many as you want
 ModelInitTypes Config::INIT_MODEL_DEFAULT_VALUE = ModelInitTypes::zero;
+AggregateTypes Config::AGGREGATE_DEFAULT_VALUE = AggregateTypes::packed;
 std::string Config::SAVE_NAME_DEFAULT_VALUE = std::string();
 int Config::SAVE_FREQ_DEFAULT_VALUE = 0;
 bool Config::SAVE_PRED_DEFAULT_VALUE = true;
@@ -152,6 +194,7 @@ int Config::RANDOM_SEED_DEFAULT_VALUE = 0;
 Config::Config()
 {
    m_model_init_type = Config::INIT_MODEL_DEFAULT_VALUE;
+   m_aggregate_type = Config::AGGREGATE_DEFAULT_VALUE;
 
    m_restore_name.clear();
 
@@ -370,6 +413,7 @@ HDF5Group &Config::save(HDF5Group &cfg_file) const
    cfg_file.put(OPTIONS_SECTION_TAG, RANDOM_SEED_SET_TAG, m_random_seed_set);
    cfg_file.put(OPTIONS_SECTION_TAG, RANDOM_SEED_TAG, m_random_seed);
    cfg_file.put(OPTIONS_SECTION_TAG, INIT_MODEL_TAG, modelInitTypeToString(m_model_init_type));
+   cfg_file.put(OPTIONS_SECTION_TAG, AGGREGATE_TAG, aggregateTypeToString(m_aggregate_type));
 
    //probit prior data
    cfg_file.put(OPTIONS_SECTION_TAG, CLASSIFY_TAG, m_classify);
@@ -464,6 +508,7 @@ bool Config::restore(const HDF5Group &cfg_file)
    m_random_seed_set = cfg_file.get(OPTIONS_SECTION_TAG, RANDOM_SEED_SET_TAG,  false);
    m_random_seed = cfg_file.get(OPTIONS_SECTION_TAG, RANDOM_SEED_TAG, Config::RANDOM_SEED_DEFAULT_VALUE);
    m_model_init_type = stringToModelInitType(cfg_file.get(OPTIONS_SECTION_TAG, INIT_MODEL_TAG, modelInitTypeToString(Config::INIT_MODEL_DEFAULT_VALUE)));
+   m_aggregate_type = stringToAggregateType(cfg_file.get(OPTIONS_SECTION_TAG, AGGREGATE_TAG, aggregateTypeToString(Config::AGGREGATE_DEFAULT_VALUE)));
 
    //restore probit prior data
    m_classify = cfg_file.get(OPTIONS_SECTION_TAG, CLASSIFY_TAG,  false);
@@ -493,6 +538,7 @@ std::ostream& Config::info(std::ostream &os, std::string indent) const
       }
 
       os << indent << "  Output file: " << getSaveName() << "\n";
+      os << indent << "  Posterior aggregates: " << getAggregateTypeAsString() << "\n";
    }
    else
    {
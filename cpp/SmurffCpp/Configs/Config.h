@@ -31,6 +31,14 @@ enum class ModelInitTypes
    zero
 };
 
+enum class AggregateTypes
+{
+   none,
+   packed,
+   diagonal,
+   spill
+};
+
 
 PriorTypes stringToPriorType(std::string name);
 
@@ -40,6 +48,10 @@ ModelInitTypes stringToModelInitType(std::string name);
 
 std::string modelInitTypeToString(ModelInitTypes type);
 
+AggregateTypes stringToAggregateType(std::string name);
+
+std::string aggregateTypeToString(AggregateTypes type);
+
 struct Config
 {
 public:
@@ -51,6 +63,7 @@ public:
    static int NUM_THREADS_DEFAULT_VALUE;
    static bool POSTPROP_DEFAULT_VALUE;
    static ModelInitTypes INIT_MODEL_DEFAULT_VALUE;
+   static AggregateTypes AGGREGATE_DEFAULT_VALUE;
    static std::string SAVE_NAME_DEFAULT_VALUE;
    static int SAVE_FREQ_DEFAULT_VALUE;
    static bool SAVE_PRED_DEFAULT_VALUE;
@@ -84,6 +97,9 @@ private:
    //-- init model
    ModelInitTypes m_model_init_type;
 
+   //-- posterior aggregates of the latents
+   AggregateTypes m_aggregate_type;
+
    //-- save
    int m_save_freq;
    bool m_save_pred;
@@ -208,6 +224,11 @@ public:
    {
       return m_data;
    }
+
+   std::vector<DataConfig> &getData()
+   {
+      return m_data;
+   }
    
    DataConfig &addData(const DataConfig & = DataConfig())
    {
@@ -289,6 +310,26 @@ public:
       m_model_init_type = stringToModelInitType(value);
    }
 
+   AggregateTypes getAggregateType() const
+   {
+      return m_aggregate_type;
+   }
+
+   void setAggregateType(AggregateTypes value)
+   {
+      m_aggregate_type = value;
+   }
+
+   std::string getAggregateTypeAsString() const
+   {
+      return aggregateTypeToString(m_aggregate_type);
+   }
+
+   void setAggregateType(std::string value)
+   {
+      m_aggregate_type = stringToAggregateType(value);
+   }
+
    std::string getRestoreName() const 
    {
       return m_restore_name;
@@ -16,6 +16,7 @@ static const std::string SCARCE_TAG = "scarce";
 static const std::string SPARSE_TAG = "sparse";
 static const std::string MATRIX_TAG = "matrix";
 static const std::string TYPE_TAG = "type";
+static const std::string BINARY_TAG = "binary";
 
 static const std::string NONE_VALUE("none");
 
@@ -23,6 +24,7 @@ static const std::string NOISE_MODEL_TAG = "noise_model";
 static const std::string PRECISION_TAG = "precision";
 static const std::string SN_INIT_TAG = "sn_init";
 static const std::string SN_MAX_TAG = "sn_max";
+static const std::string FUSED_SUMSQ_TAG = "fused_sumsq";
 static const std::string NOISE_THRESHOLD_TAG = "noise_threshold";
 
 DataConfig::DataConfig () 
@@ -78,6 +80,7 @@ DataConfig::~DataConfig()
 void DataConfig::check() const
 {
    THROWERROR_ASSERT(hasData());
+   THROWERROR_ASSERT_MSG(!isBinary() || !isDense(), "Binary data has to be sparse");
 
    if (isDense())
    {
@@ -128,27 +131,46 @@ void DataConfig::setData(const SparseTensor &m, bool isScarce)
    check();
 }
 
+void DataConfig::releaseData()
+{
+   if (!hasData() || m_isReleased)
+      return;
+
+   m_released_dims = getDims();
+   m_released_nnz = getNNZ();
+
+   m_dense_matrix_data = Matrix();
+   m_sparse_matrix_data = SparseMatrix();
+   m_dense_tensor_data = DenseTensor();
+   m_sparse_tensor_data = SparseTensor();
+   m_isReleased = true;
+}
+
 const Matrix &DataConfig::getDenseMatrixData() const
 {
    THROWERROR_ASSERT(hasData() && isDense() && isMatrix());
+   THROWERROR_ASSERT_MSG(!m_isReleased, "Data has been released");
    return m_dense_matrix_data;
 }
 
 const SparseMatrix &DataConfig::getSparseMatrixData() const
 {
    THROWERROR_ASSERT(hasData() && !isDense() && isMatrix());
+   THROWERROR_ASSERT_MSG(!m_isReleased, "Data has been released");
    return m_sparse_matrix_data;
 }
 
 const SparseTensor &DataConfig::getSparseTensorData() const
 {
    THROWERROR_ASSERT(hasData() && !isDense() && !isMatrix());
+   THROWERROR_ASSERT_MSG(!m_isReleased, "Data has been released");
    return m_sparse_tensor_data;
 }
 
 const DenseTensor &DataConfig::getDenseTensorData() const
 {
    THROWERROR_ASSERT(hasData() && isDense() && !isMatrix());
+   THROWERROR_ASSERT_MSG(!m_isReleased, "Data has been released");
    return m_dense_tensor_data;
 }
 
@@ -191,6 +213,18 @@ bool DataConfig::isScarce() const
    return m_isScarce;
 }
 
+bool DataConfig::isBinary() const
+{
+   return m_isBinary;
+}
+
+void DataConfig::setBinary(bool value)
+{
+   m_isBinary = value;
+   if (hasData())
+      check();
+}
+
 bool DataConfig::isMatrix() const
 {
    return m_isMatrix;
@@ -200,6 +234,9 @@ std::uint64_t DataConfig::getNNZ() const
 {
    THROWERROR_ASSERT(hasData());
 
+   if (m_isReleased)
+      return m_released_nnz;
+
         if (isMatrix() && isDense())        return getDenseMatrixData().nonZeros();
    else if (isMatrix() && !isDense())  return getSparseMatrixData().nonZeros();
    else if (!isMatrix() && !isDense()) return getSparseTensorData().getNNZ();
@@ -216,6 +253,9 @@ const std::vector<std::uint64_t> DataConfig::getDims() const
 {
    THROWERROR_ASSERT(hasData());
 
+   if (m_isReleased)
+      return m_released_dims;
+
    if (isMatrix() && isDense())
    {
       const auto &m = getDenseMatrixData();
@@ -336,6 +376,7 @@ void DataConfig::save(HDF5Group& cfg_file, const std::string& sectionName) const
    std::string type_str = isDense() ? DENSE_TAG : isScarce() ? SCARCE_TAG : SPARSE_TAG;
    cfg_file.put(sectionName, TYPE_TAG, type_str);
    cfg_file.put(sectionName, MATRIX_TAG, isMatrix());
+   cfg_file.put(sectionName, BINARY_TAG, isBinary());
 
    //write noise config
    auto &noise_config = getNoiseConfig();
@@ -345,6 +386,7 @@ void DataConfig::save(HDF5Group& cfg_file, const std::string& sectionName) const
       cfg_file.put(sectionName, PRECISION_TAG, noise_config.getPrecision());
       cfg_file.put(sectionName, SN_INIT_TAG, noise_config.getSnInit());
       cfg_file.put(sectionName, SN_MAX_TAG, noise_config.getSnMax());
+      cfg_file.put(sectionName, FUSED_SUMSQ_TAG, noise_config.getFusedSumsq());
       cfg_file.put(sectionName, NOISE_THRESHOLD_TAG, noise_config.getThreshold());
    }
 
@@ -370,6 +412,7 @@ bool DataConfig::restore(const HDF5Group& cfg_file, const std::string& sectionNa
    m_isDense = cfg_file.get(sectionName, TYPE_TAG, DENSE_TAG) == DENSE_TAG;
    m_isScarce = cfg_file.get(sectionName, TYPE_TAG, SCARCE_TAG) == SCARCE_TAG;
    m_isMatrix = cfg_file.get(sectionName, MATRIX_TAG, true);
+   m_isBinary = cfg_file.get(sectionName, BINARY_TAG, false);
 
    if (isMatrix() && isDense())
       cfg_file.read(sectionName, DATA_TAG, getDenseMatrixData());
@@ -392,6 +435,7 @@ bool DataConfig::restore(const HDF5Group& cfg_file, const std::string& sectionNa
       noise.setPrecision(cfg_file.get(sectionName, PRECISION_TAG, NoiseConfig::PRECISION_DEFAULT_VALUE));
       noise.setSnInit(cfg_file.get(sectionName, SN_INIT_TAG, NoiseConfig::ADAPTIVE_SN_INIT_DEFAULT_VALUE));
       noise.setSnMax(cfg_file.get(sectionName, SN_MAX_TAG, NoiseConfig::ADAPTIVE_SN_MAX_DEFAULT_VALUE));
+      noise.setFusedSumsq(cfg_file.get(sectionName, FUSED_SUMSQ_TAG, NoiseConfig::ADAPTIVE_FUSED_SUMSQ_DEFAULT_VALUE));
       noise.setThreshold(cfg_file.get(sectionName, NOISE_THRESHOLD_TAG, NoiseConfig::PROBIT_DEFAULT_VALUE));
    }
 
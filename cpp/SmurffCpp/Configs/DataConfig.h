@@ -25,6 +25,8 @@ namespace smurff
       bool m_isDense;
       bool m_isScarce;
       bool m_isMatrix;
+      bool m_isBinary = false;
+      bool m_isReleased = false;
 
    private:
       PVec<>      m_pos;
@@ -35,6 +37,10 @@ namespace smurff
       DenseTensor  m_dense_tensor_data;
       SparseTensor m_sparse_tensor_data;
 
+      // kept when the data is released
+      std::vector<std::uint64_t> m_released_dims;
+      std::uint64_t m_released_nnz = 0;
+
    public:
       virtual ~DataConfig();
 
@@ -51,6 +57,10 @@ namespace smurff
       void setData(const DenseTensor &m);
       void setData(const SparseTensor &m, bool isScarce = true);
 
+      // frees the data after it has been copied into a Data object,
+      // dimensions and number of non-zeros are kept
+      void releaseData();
+
       const Matrix       &getDenseMatrixData()  const;
       const SparseMatrix &getSparseMatrixData() const;
       const SparseTensor &getSparseTensorData() const;
@@ -69,6 +79,10 @@ namespace smurff
       bool isDense() const;
       bool isScarce() const;
 
+      // sparse data where every non-zero is 1, values are not used
+      bool isBinary() const;
+      void setBinary(bool value);
+
       std::uint64_t getNModes() const;
       std::uint64_t getNNZ() const;
 
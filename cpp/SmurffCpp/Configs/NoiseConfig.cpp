@@ -19,6 +19,7 @@ NoiseTypes NoiseConfig::NOISE_TYPE_DEFAULT_VALUE = NoiseTypes::fixed;
 double NoiseConfig::PRECISION_DEFAULT_VALUE = 5.0;
 double NoiseConfig::ADAPTIVE_SN_INIT_DEFAULT_VALUE = 1.0;
 double NoiseConfig::ADAPTIVE_SN_MAX_DEFAULT_VALUE = 10.0;
+bool NoiseConfig::ADAPTIVE_FUSED_SUMSQ_DEFAULT_VALUE = false;
 double NoiseConfig::PROBIT_DEFAULT_VALUE = 0.0;
 
 NoiseConfig::NoiseConfig(NoiseTypes nt)
@@ -29,16 +30,18 @@ NoiseConfig::NoiseConfig(NoiseTypes nt)
    // for adaptive gausssian noise
    m_sn_init = ADAPTIVE_SN_INIT_DEFAULT_VALUE;
    m_sn_max = ADAPTIVE_SN_MAX_DEFAULT_VALUE;
+   m_fused_sumsq = ADAPTIVE_FUSED_SUMSQ_DEFAULT_VALUE;
 
    // for probit
    m_threshold = PROBIT_DEFAULT_VALUE;
 }
 
-NoiseConfig::NoiseConfig(const std::string type, double precision, double sn_init, double sn_max, double threshold)
+NoiseConfig::NoiseConfig(const std::string type, double precision, double sn_init, double sn_max, double threshold, bool fused_sumsq)
    : m_noise_type(stringToNoiseType(type))
    , m_precision(precision)
    , m_sn_init(sn_init)
    , m_sn_max(sn_max)
+   , m_fused_sumsq(fused_sumsq)
    , m_threshold(threshold)
    {}
 
@@ -131,6 +134,16 @@ void NoiseConfig::setSnMax(double value)
    m_sn_max = value;
 }
 
+bool NoiseConfig::getFusedSumsq() const
+{
+   return m_fused_sumsq;
+}
+
+void NoiseConfig::setFusedSumsq(bool value)
+{
+   m_fused_sumsq = value;
+}
+
 double NoiseConfig::getThreshold() const
 {
    return m_threshold;
@@ -26,6 +26,7 @@ namespace smurff
       static double PRECISION_DEFAULT_VALUE;
       static double ADAPTIVE_SN_INIT_DEFAULT_VALUE;
       static double ADAPTIVE_SN_MAX_DEFAULT_VALUE;
+      static bool ADAPTIVE_FUSED_SUMSQ_DEFAULT_VALUE;
       static double PROBIT_DEFAULT_VALUE;
 
    private:
@@ -37,13 +38,15 @@ namespace smurff
       // for adaptive gausssian noise
       double m_sn_init;
       double m_sn_max;
+      bool m_fused_sumsq;
 
       // for probit
       double m_threshold;
 
    public:
       NoiseConfig(NoiseTypes nt = NoiseTypes::unset);
-      NoiseConfig(const std::string, double precision, double sn_init, double sn_max, double threshold);
+      NoiseConfig(const std::string, double precision, double sn_init, double sn_max, double threshold,
+                  bool fused_sumsq = ADAPTIVE_FUSED_SUMSQ_DEFAULT_VALUE);
 
    public:
       bool validate() const;
@@ -75,6 +78,10 @@ namespace smurff
 
       void setSnMax(double value);
 
+      bool getFusedSumsq() const;
+
+      void setFusedSumsq(bool value);
+
       double getThreshold() const;
 
       void setThreshold(double value);
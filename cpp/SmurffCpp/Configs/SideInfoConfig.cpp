@@ -4,6 +4,7 @@
 
 #include <SmurffCpp/Utils/HDF5Group.h>
 #include <SmurffCpp/Utils/StringUtils.h>
+#include <SmurffCpp/Utils/Error.h>
 
 #include "SideInfoConfig.h"
 
@@ -12,19 +13,59 @@ namespace smurff {
 static const std::string SIDE_INFO_PREFIX = "side_info";
 static const std::string TOL_TAG = "tol";
 static const std::string DIRECT_TAG = "direct";
+static const std::string SPARSE_DIRECT_TAG = "sparse_direct";
 static const std::string THROW_ON_CHOLESKY_ERROR_TAG = "throw_on_cholesky_error";
+static const std::string PRECONDITIONER_TAG = "preconditioner";
 static const std::string NUMBER_TAG = "nr";
 
+static const std::string PRECONDITIONER_NAME_NONE = "none";
+static const std::string PRECONDITIONER_NAME_JACOBI = "jacobi";
+static const std::string PRECONDITIONER_NAME_BLOCK_JACOBI = "block_jacobi";
+
 const bool   SideInfoConfig::DIRECT_DEFAULT_VALUE = true;
 const double SideInfoConfig::BETA_PRECISION_DEFAULT_VALUE = 10.0;
 const double SideInfoConfig::TOL_DEFAULT_VALUE = 1e-6;
+const PreconditionerTypes SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE = PreconditionerTypes::jacobi;
+
+PreconditionerTypes stringToPreconditionerType(std::string name)
+{
+   if(name == PRECONDITIONER_NAME_NONE)
+      return PreconditionerTypes::none;
+   else if (name == PRECONDITIONER_NAME_JACOBI)
+      return PreconditionerTypes::jacobi;
+   else if (name == PRECONDITIONER_NAME_BLOCK_JACOBI)
+      return PreconditionerTypes::block_jacobi;
+   else
+   {
+      THROWERROR("Invalid preconditioner type " + name);
+   }
+}
+
+std::string preconditionerTypeToString(PreconditionerTypes type)
+{
+   switch(type)
+   {
+      case PreconditionerTypes::none:
+         return PRECONDITIONER_NAME_NONE;
+      case PreconditionerTypes::jacobi:
+         return PRECONDITIONER_NAME_JACOBI;
+      case PreconditionerTypes::block_jacobi:
+         return PRECONDITIONER_NAME_BLOCK_JACOBI;
+      default:
+      {
+         THROWERROR("Invalid preconditioner type");
+      }
+   }
+}
 
 SideInfoConfig::SideInfoConfig(const Matrix &data, const NoiseConfig &ncfg)
    : DataConfig(data, ncfg)
 {
    m_tol = SideInfoConfig::TOL_DEFAULT_VALUE;
    m_direct = SideInfoConfig::DIRECT_DEFAULT_VALUE;
+   m_sparse_direct = false;
    m_throw_on_cholesky_error = false;
+   m_preconditioner = SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE;
 }
 
 SideInfoConfig::SideInfoConfig(const SparseMatrix &data, const NoiseConfig &ncfg)
@@ -32,7 +73,9 @@ SideInfoConfig::SideInfoConfig(const SparseMatrix &data, const NoiseConfig &ncfg
 {
    m_tol = SideInfoConfig::TOL_DEFAULT_VALUE;
    m_direct = SideInfoConfig::DIRECT_DEFAULT_VALUE;
+   m_sparse_direct = false;
    m_throw_on_cholesky_error = false;
+   m_preconditioner = SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE;
 }
 
 void SideInfoConfig::save(HDF5Group& cfg_file, std::size_t prior_index) const
@@ -42,7 +85,9 @@ void SideInfoConfig::save(HDF5Group& cfg_file, std::size_t prior_index) const
    //macau config params
    cfg_file.put(sectionName, TOL_TAG, m_tol);
    cfg_file.put(sectionName, DIRECT_TAG, m_direct);
+   cfg_file.put(sectionName, SPARSE_DIRECT_TAG, m_sparse_direct);
    cfg_file.put(sectionName, THROW_ON_CHOLESKY_ERROR_TAG, m_throw_on_cholesky_error);
+   cfg_file.put(sectionName, PRECONDITIONER_TAG, preconditionerTypeToString(m_preconditioner));
 
    //data
    DataConfig::save(cfg_file, sectionName);
@@ -60,7 +105,9 @@ bool SideInfoConfig::restore(const HDF5Group& cfg_file, std::size_t prior_index)
    //restore side info properties
    m_tol = cfg_file.get(sectionName, TOL_TAG, SideInfoConfig::TOL_DEFAULT_VALUE);
    m_direct = cfg_file.get(sectionName, DIRECT_TAG, false);
+   m_sparse_direct = cfg_file.get(sectionName, SPARSE_DIRECT_TAG, false);
    m_throw_on_cholesky_error = cfg_file.get(sectionName, THROW_ON_CHOLESKY_ERROR_TAG, false);
+   m_preconditioner = stringToPreconditionerType(cfg_file.get(sectionName, PRECONDITIONER_TAG, preconditionerTypeToString(SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE)));
 
    DataConfig::restore(cfg_file, sectionName);
 
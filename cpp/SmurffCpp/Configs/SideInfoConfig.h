@@ -10,17 +10,32 @@ namespace smurff
 {
    class HDF5Group;
 
+   // preconditioner of the CG solver for the link matrix
+   enum class PreconditionerTypes
+   {
+      none,
+      jacobi,       // the diagonal of F'F + beta_precision * I
+      block_jacobi  // its diagonal blocks of 64 x 64 features
+   };
+
+   PreconditionerTypes stringToPreconditionerType(std::string name);
+
+   std::string preconditionerTypeToString(PreconditionerTypes type);
+
    class SideInfoConfig : public DataConfig
    {
    public:
       static const bool DIRECT_DEFAULT_VALUE;
       static const double BETA_PRECISION_DEFAULT_VALUE;
       static const double TOL_DEFAULT_VALUE;
+      static const PreconditionerTypes PRECONDITIONER_DEFAULT_VALUE;
 
    private:
       double m_tol = TOL_DEFAULT_VALUE;
       bool m_direct = DIRECT_DEFAULT_VALUE;
+      bool m_sparse_direct = false; // the direct solver factors a sparse F'F
       bool m_throw_on_cholesky_error = false;
+      PreconditionerTypes m_preconditioner = PRECONDITIONER_DEFAULT_VALUE;
 
    public:
       SideInfoConfig() {}; //empty
@@ -48,6 +63,16 @@ namespace smurff
          m_direct = value;
       }
 
+      bool getSparseDirect() const
+      {
+         return m_sparse_direct;
+      }
+
+      void setSparseDirect(bool value)
+      {
+         m_sparse_direct = value;
+      }
+
       bool getThrowOnCholeskyError() const
       {
          return m_throw_on_cholesky_error;
@@ -58,6 +83,21 @@ namespace smurff
          m_throw_on_cholesky_error = value;
       }
 
+      PreconditionerTypes getPreconditionerType() const
+      {
+         return m_preconditioner;
+      }
+
+      void setPreconditionerType(PreconditionerTypes value)
+      {
+         m_preconditioner = value;
+      }
+
+      void setPreconditionerType(std::string value)
+      {
+         m_preconditioner = stringToPreconditionerType(value);
+      }
+
    public:
       void save(HDF5Group& writer, std::size_t prior_index) const;
       bool restore(const HDF5Group& reader, std::size_t prior_index);
@@ -0,0 +1,84 @@
+#include "BinaryMatrixData.h"
+
+#include <SmurffCpp/Noises/NoiseSampler.hpp>
+
+namespace smurff {
+
+BinaryMatrixData::BinaryMatrixData(const SparseMatrix &Y)
+   : FullMatrixData<SparsePattern>(SparsePattern(Y))
+{
+   this->name = "BinaryMatrixData [fully known]";
+}
+
+void BinaryMatrixData::getMuLambda(const SubModel& model, uint32_t mode, int d, Vector& rr, Matrix& MM) const
+{
+    const auto& Y = this->Y();
+    auto Vf = *model.CVbegin(mode);
+    auto &ns = noise();
+
+    with_sampler(ns, [&](const auto &sample) {
+        for (SparsePattern::ModeIterator it(Y, mode, d); it; ++it) 
+        {
+            const auto &row = Vf.row(it.index());
+            double noisy_val = sample(model, [&]() { return this->pos(mode, d, it.index()); }, 1.0);
+            rr.noalias() += row * noisy_val; // rr = rr + V[m] * alpha
+        }
+    });
+
+    MM.noalias() += ns.getAlpha() * VV[mode]; // MM = MM + VV[m]
+}
+
+double BinaryMatrixData::train_rmse(const SubModel& model) const
+{
+   return std::sqrt(sumsq(model) / this->size());
+}
+
+// variance of a 0/1 matrix: mean * (1 - mean)
+double BinaryMatrixData::var_total() const
+{
+   const double cwise_mean = (double)this->nnz() / this->size();
+   double var = cwise_mean * (1.0 - cwise_mean);
+   if (var <= 0.0 || std::isnan(var))
+   {
+      // if var cannot be computed using 1.0
+      var = 1.0;
+   }
+
+   return var;
+}
+
+// ||U * V^T - Y||^2 = trace((U^T * U) * (V^T * V)) - 2 * sum_nnz (u . v) + nnz
+double BinaryMatrixData::sumsq(const SubModel& model) const
+{
+   const auto U = model.U(0);
+   const auto V = model.U(1);
+   double cross = 0.0;
+
+   #pragma omp parallel for schedule(guided) reduction(+:cross)
+   for(int r = 0; r < Y().nouter(0); ++r) // rows
+   {
+      for (SparsePattern::ModeIterator it(Y(), 0, r); it; ++it) // cols
+      {
+         cross += U.row(r).dot(V.row(it.index()));
+      }
+   }
+
+   // guard against round-off when the fit is (almost) perfect
+   return std::max(0.0, sumsq_pred(model) - 2.0 * cross + this->nnz());
+}
+
+// same closed form for one row, VV[mode] was cached by update_pnm
+double BinaryMatrixData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   const auto U = model.U(mode);
+   auto Vf = *model.CVbegin(mode);
+   double sumsq = (U.row(d) * VV[mode]).dot(U.row(d));
+
+   for (SparsePattern::ModeIterator it(Y(), mode, d); it; ++it)
+   {
+      sumsq += 1.0 - 2.0 * U.row(d).dot(Vf.row(it.index()));
+   }
+
+   return std::max(0.0, sumsq);
+}
+} // end namespace smurff
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "FullMatrixData.hpp"
+
+namespace smurff
+{
+   // fully known sparse matrix where all non-zeros are 1 (implicit feedback),
+   // only the structure is stored
+   class BinaryMatrixData : public FullMatrixData<SparsePattern>
+   {
+   public:
+      BinaryMatrixData(const SparseMatrix &Y);
+
+      void getMuLambda(const SubModel& model, std::uint32_t mode, int d, Vector& rr, Matrix& MM) const override;
+
+   public:
+      double train_rmse(const SubModel& model) const override;
+
+   public:
+      double var_total() const override;
+      
+      double sumsq(const SubModel& model) const override;
+      double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
+  };
+}
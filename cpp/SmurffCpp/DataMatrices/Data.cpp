@@ -8,6 +8,7 @@
 #include <SmurffCpp/DataMatrices/ScarceMatrixData.h>
 #include <SmurffCpp/DataMatrices/DenseMatrixData.h>
 #include <SmurffCpp/DataMatrices/MatricesData.h>
+#include <SmurffCpp/DataMatrices/BinaryMatrixData.h>
 
 //tensor classes
 #include <SmurffCpp/DataTensors/TensorData.h>
@@ -26,6 +27,10 @@ Data::Data()
 
 void Data::init()
 {
+    // data used outside of a session gets its own arenas
+    if (!m_arenas)
+       setArenas(std::make_shared<thread_vector<ScratchArena> >());
+
     init_pre();
 
     init_post();
@@ -41,6 +46,27 @@ void Data::update(const SubModel& model)
    noise().update(model);
 }
 
+void Data::update_sumsq(const SubModel& model, uint32_t mode, int d)
+{
+   // once the last mode is sampled the residuals of its rows are final
+   if (mode != nmode() - 1 || !noise().fusedSumsq())
+      return;
+
+   noise().addSumsq(sumsq_row(model, mode, d));
+}
+
+//#### scratch space ####
+
+ScratchArena &Data::arena() const
+{
+   return m_arenas->local();
+}
+
+void Data::setArenas(std::shared_ptr<thread_vector<ScratchArena> > arenas)
+{
+   m_arenas = arenas;
+}
+
 //#### dimension functions ####
 
 std::uint64_t Data::size() const
@@ -53,6 +79,11 @@ int Data::dim(int m) const
    return dim().at(m);
 }
 
+std::uint64_t Data::row_nobs(uint32_t mode, int d) const
+{
+   return row_nnz(mode, d);
+}
+
 //#### view functions ####
 
 int Data::nview(int mode) const
@@ -130,6 +161,12 @@ std::shared_ptr<Data> Data::create(const DataConfig& dc)
    {
       if (dc.isDense())
         ret = std::make_shared<DenseMatrixData>(dc.getDenseMatrixData());
+      else if (dc.isBinary())
+      {
+        // with only ones observed scarce binary data has nothing to learn
+        THROWERROR_ASSERT_MSG(!dc.isScarce(), "Binary matrix data has to be fully known (not scarce)");
+        ret = std::make_shared<BinaryMatrixData>(dc.getSparseMatrixData());
+      }
       else if (!dc.isScarce())
         ret = std::make_shared<SparseMatrixData>(dc.getSparseMatrixData());
       else
@@ -140,9 +177,9 @@ std::shared_ptr<Data> Data::create(const DataConfig& dc)
       if (dc.isDense())
          ret = std::make_shared<TensorData>(dc.getDenseTensorData());
       else if (!dc.isScarce())
-        ret = std::make_shared<TensorData>(dc.getSparseTensorData()); // FIXME
+        ret = std::make_shared<TensorData>(dc.getSparseTensorData(), dc.isBinary()); // FIXME
       else
-        ret = std::make_shared<TensorData>(dc.getSparseTensorData()); // FIXME
+        ret = std::make_shared<TensorData>(dc.getSparseTensorData(), dc.isBinary()); // FIXME
    }
 
    ret->setNoiseModel(NoiseFactory::create_noise_model(dc.getNoiseConfig()));
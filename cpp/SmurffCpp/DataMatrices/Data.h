@@ -7,6 +7,8 @@
 
 #include <SmurffCpp/Noises/INoiseModel.h>
 #include <SmurffCpp/Utils/PVec.hpp>
+#include <SmurffCpp/Utils/ScratchArena.h>
+#include <SmurffCpp/Utils/ThreadVector.hpp>
 
 #include <SmurffCpp/Types.h>
 
@@ -47,6 +49,8 @@ namespace smurff
       virtual std::uint64_t nnz() const = 0; // number of non zero elements
       virtual std::uint64_t nna() const = 0; // number of NA elements
       virtual PVec<> dim() const = 0; // dimension vector
+      virtual std::uint64_t row_nnz(uint32_t mode, int d) const = 0; // number of known elements in row d of mode
+      virtual std::uint64_t row_nobs(uint32_t mode, int d) const; // same, with the implicit zeros of fully known data
 
    public:
       std::uint64_t size() const; // number of all elements (dimension dot product)
@@ -71,12 +75,25 @@ namespace smurff
 
    public:
       virtual double sumsq(const SubModel& model) const = 0;
+      virtual double sumsq_row(const SubModel& model, uint32_t mode, int d) const = 0; // sumsq of row d in mode
       virtual double var_total() const = 0;
 
+      // fused residual computation: called after row d of mode is sampled
+      virtual void update_sumsq(const SubModel& model, uint32_t mode, int d);
+
    public:
       INoiseModel &noise() const;
       void setNoiseModel(std::unique_ptr<INoiseModel> &&nm);
 
+   //#### scratch space ####
+   private:
+      std::shared_ptr<thread_vector<ScratchArena> > m_arenas; // per-thread, owned by the session
+
+   public:
+      // scratch arena of this thread for the temporaries of getMuLambda and sample_latent
+      ScratchArena &arena() const;
+      virtual void setArenas(std::shared_ptr<thread_vector<ScratchArena> > arenas);
+
    //#### info functions ####
    public:
       virtual std::ostream& info(std::ostream& os, std::string indent);
@@ -1,28 +1,59 @@
 #include "DenseMatrixData.h"
 
+#include <SmurffCpp/Noises/NoiseSampler.hpp>
+
 namespace smurff {
 
+// number of matrix elements per block in sumsq
+static const int sumsq_block_size = 1 << 18;
+
 DenseMatrixData::DenseMatrixData(Matrix Y)
    : FullMatrixData<Matrix>(Y)
 {
     this->name = "DenseMatrixData [fully known]";
 }
 
+void DenseMatrixData::init_post()
+{
+    FullMatrixData<Matrix>::init_post();
+
+    // gaussian noise does not depend on the model: noisy_val = alpha * val
+    gaussian = is_gaussian(noise());
+}
+
+//caches VV and, for gaussian noise, all rr vectors of this mode in one GEMM
+void DenseMatrixData::update_pnm(const SubModel& model, uint32_t mode)
+{
+    FullMatrixData<Matrix>::update_pnm(model, mode);
+
+    if (gaussian)
+        YV[mode].noalias() = this->Y(mode) * *model.CVbegin(mode);
+}
+
 //d is an index of column in U matrix
 void DenseMatrixData::getMuLambda(const SubModel& model, uint32_t mode, int d, Vector& rr, Matrix& MM) const
 {
-    auto &Y = this->Y(mode).row(d);
-    auto Vf = *model.CVbegin(mode);
     auto &ns = noise();
 
-    for(int r = 0; r<Y.cols(); ++r) 
+    if (gaussian)
     {
-        const auto &row = Vf.row(r);
-        PVec<> pos = this->pos(mode, d, r);
-        double noisy_val = ns.sample(model, pos, Y(r));
-        rr.noalias() += row * noisy_val; // rr = rr + (V[m] * noisy_y[d]) 
+        rr.noalias() += ns.getAlpha() * YV[mode].row(d); // rr = rr + (V[m] * y[d]) * alpha
+        MM.noalias() += ns.getAlpha() * VV[mode]; // MM = MM + VV[m]
+        return;
     }
 
+    auto &Y = this->Y(mode).row(d);
+    auto Vf = *model.CVbegin(mode);
+    ScratchArena::Frame frame(arena());
+    auto noisy_vals = arena().vector(Y.cols());
+
+    with_sampler(ns, [&](const auto &sample) {
+        sample_panel(sample, model, Vf, model.U(mode).row(d), Y, noisy_vals,
+                     [&](int r) { return this->pos(mode, d, r); });
+    });
+
+    rr.noalias() += noisy_vals * Vf; // rr = rr + (V[m] * noisy_y[d]) 
+
     MM.noalias() += ns.getAlpha() * VV[mode]; // MM = MM + VV[m]
 }
 
@@ -47,19 +78,41 @@ double DenseMatrixData::var_total() const
 }
 
 // for the adaptive gaussian noise
+// ||Y - U * V^T||^2 computed in blocks of rows, one GEMM per block
 double DenseMatrixData::sumsq(const SubModel& model) const
 {
+   const auto U = model.U(0);
+   const auto V = model.U(1);
+   const int block_rows = std::max(1, sumsq_block_size / std::max(1, this->ncol()));
+   const int nblocks = (this->nrow() + block_rows - 1) / block_rows;
    double sumsq = 0.0;
 
    #pragma omp parallel for schedule(guided) reduction(+:sumsq)
-   for (int j = 0; j < this->ncol(); j++) 
+   for (int block = 0; block < nblocks; block++)
    {
-      for (int i = 0; i < this->nrow(); i++) 
-      {
-         sumsq += std::pow(model.predict({i,j}) - this->Y()(i,j), 2);
-      }
+      const int row = block * block_rows;
+      const int brows = std::min(block_rows, this->nrow() - row);
+      Matrix R = this->Y().middleRows(row, brows);
+      R.noalias() -= U.middleRows(row, brows) * V.transpose();
+      sumsq += R.squaredNorm();
    }
 
    return sumsq;
 }
+
+double DenseMatrixData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   const auto U = model.U(mode);
+
+   // ||y - u * V^T||^2 = y . y - 2 * u . (y * V) + u * (V^T * V) * u^T
+   if (gaussian)
+   {
+      const double sumsq = this->Y(mode).row(d).squaredNorm()
+                         - 2.0 * U.row(d).dot(YV[mode].row(d))
+                         + (U.row(d) * VV[mode]).dot(U.row(d));
+      return std::max(0.0, sumsq);
+   }
+
+   return (this->Y(mode).row(d) - U.row(d) * (*model.CVbegin(mode)).transpose()).squaredNorm();
+}
 } // end namespace smurff
@@ -6,8 +6,15 @@ namespace smurff
 {
    class DenseMatrixData : public FullMatrixData<Matrix>
    {
+   private:
+      Matrix YV[2]; // Y * V for the whole mode, only for gaussian noise
+      bool gaussian = false;
+
    public:
       DenseMatrixData(Matrix Y);
+
+      void init_post() override;
+      void update_pnm(const SubModel& model, std::uint32_t mode) override;
       void getMuLambda(const SubModel& model, std::uint32_t mode, int d, Vector& rr, Matrix& MM) const override;
 
    public:
@@ -17,5 +24,6 @@ namespace smurff
       double var_total() const override;
       
       double sumsq(const SubModel& model) const override;
+      double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
    };
 }
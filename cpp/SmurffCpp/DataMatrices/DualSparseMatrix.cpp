@@ -0,0 +1,34 @@
+#include "DualSparseMatrix.h"
+
+namespace smurff {
+
+DualSparseMatrix::DualSparseMatrix(SparseMatrix Y)
+{
+   this->swap(Y);
+   this->makeCompressed();
+
+   const Index nnz = nonZeros();
+
+   // count non-zeros per column
+   m_col_ptr.assign(cols() + 1, 0);
+   for (Index i = 0; i < nnz; i++)
+      m_col_ptr[innerIndexPtr()[i] + 1]++;
+
+   for (Index c = 0; c < cols(); c++)
+      m_col_ptr[c + 1] += m_col_ptr[c];
+
+   // scatter rows in order, so that rows are sorted within each column
+   m_col_rows.resize(nnz);
+   m_col_perm.resize(nnz);
+   std::vector<StorageIndex> next(m_col_ptr.begin(), m_col_ptr.end() - 1);
+   for (Index r = 0; r < rows(); r++)
+   {
+      for (Index i = outerIndexPtr()[r]; i < outerIndexPtr()[r + 1]; i++)
+      {
+         const StorageIndex k = next[innerIndexPtr()[i]]++;
+         m_col_rows[k] = r;
+         m_col_perm[k] = i;
+      }
+   }
+}
+} // end namespace smurff
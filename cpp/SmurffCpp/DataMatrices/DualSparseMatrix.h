@@ -0,0 +1,76 @@
+#pragma once
+
+#include <vector>
+
+#include <SmurffCpp/Types.h>
+
+namespace smurff
+{
+   // Sparse matrix that is stored once (CSR) but can be traversed along both modes.
+   //
+   // Mode 0 are the rows of the CSR matrix. Mode 1 (the columns) uses a CSC
+   // index on top of it: for each column the row of every non-zero and its
+   // position in the CSR arrays. Both modes share the same values.
+   class DualSparseMatrix : public SparseMatrix
+   {
+   private:
+      std::vector<StorageIndex> m_col_ptr;  // [ncols + 1] offsets of each column
+      std::vector<StorageIndex> m_col_rows; // [nnz] row of each non-zero, column by column
+      std::vector<StorageIndex> m_col_perm; // [nnz] position of each non-zero in the CSR arrays
+
+   public:
+      DualSparseMatrix(SparseMatrix Y = SparseMatrix());
+
+   public:
+      // number of rows in mode
+      Index nouter(int mode) const
+      {
+         return mode == 0 ? rows() : cols();
+      }
+
+      // non-zeros of row n in mode are [begin(mode, n), end(mode, n))
+      Index begin(int mode, Index n) const
+      {
+         return mode == 0 ? outerIndexPtr()[n] : m_col_ptr[n];
+      }
+
+      Index end(int mode, Index n) const
+      {
+         return mode == 0 ? outerIndexPtr()[n + 1] : m_col_ptr[n + 1];
+      }
+
+      // column (mode 0) or row (mode 1) of non-zero i
+      StorageIndex index(int mode, Index i) const
+      {
+         return mode == 0 ? innerIndexPtr()[i] : m_col_rows[i];
+      }
+
+      const float_type &value(int mode, Index i) const
+      {
+         return valuePtr()[mode == 0 ? i : m_col_perm[i]];
+      }
+
+   public:
+      // iterates over the non-zeros of row n in mode
+      class ModeIterator
+      {
+      private:
+         const DualSparseMatrix &m_Y;
+         const int m_mode;
+         Index m_pos;
+         const Index m_end;
+
+      public:
+         ModeIterator(const DualSparseMatrix &Y, int mode, Index n)
+            : m_Y(Y), m_mode(mode), m_pos(Y.begin(mode, n)), m_end(Y.end(mode, n))
+         {
+         }
+
+         ModeIterator &operator++() { m_pos++; return *this; }
+         operator bool() const { return m_pos < m_end; }
+
+         StorageIndex index() const { return m_Y.index(m_mode, m_pos); }
+         const float_type &value() const { return m_Y.value(m_mode, m_pos); }
+      };
+   };
+}
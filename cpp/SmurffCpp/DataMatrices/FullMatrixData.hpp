@@ -14,6 +14,7 @@ namespace smurff
    {
    protected:
       Matrix VV[2]; // sum of v * vT, where v is column of V
+      bool VV1_fresh = false; // VV[1] still matches U(0)
 
    public:
       FullMatrixData(YType Y) 
@@ -26,8 +27,18 @@ namespace smurff
       //purpose of update_pnm is to cache VV matrix
       void update_pnm(const SubModel& model, uint32_t mode) override
       {
-         auto Vf = *model.CVbegin(mode);
-         const int nl = model.nlatent();
+         VV[mode] = gram(*model.CVbegin(mode));
+
+         // U(0) is sampled after update_pnm of mode 0, VV[1] is stale from then on
+         VV1_fresh = (mode == 1);
+      }
+
+   protected:
+      // sum of v * vT over all rows v of Vf
+      template<class VType>
+      static Matrix gram(const VType& Vf)
+      {
+         const int nl = Vf.cols();
          thread_vector<Matrix> VVs(Matrix::Zero(nl, nl));
 
          //for each column v of Vf - calculate v * vT and add to VVs
@@ -38,12 +49,32 @@ namespace smurff
             VVs.local() += v.transpose() * v; // VVs = Vvs + vT * v
          }
 
-         VV[mode] = VVs.combine(); //accumulate sum
+         return VVs.combine(); //accumulate sum
       }
 
+      // sum of squared predictions over all cells of the matrix: trace((U^T * U) * (V^T * V))
+      //
+      // VV[1] holds U(0)^T * U(0) from the last update_pnm of mode 1. In a sampling sweep
+      // U(0) does not change until the next update_pnm of mode 0, so until then it is
+      // reused and only the Gram matrix of the freshly sampled U(1) is computed here.
+      double sumsq_pred(const SubModel& model) const
+      {
+         const Matrix UU = VV1_fresh ? VV[1] : gram(model.U(0));
+         const Matrix VV1 = gram(model.U(1));
+         return UU.cwiseProduct(VV1).sum(); // trace(A * B) for symmetric A and B
+      }
+
+   public:
+
       std::uint64_t nna() const override
       {
          return 0;
       }
+
+      // row_nnz counts the stored elements, every element of a row is observed
+      std::uint64_t row_nobs(uint32_t mode, int d) const override
+      {
+         return mode == 0 ? this->ncol() : this->nrow();
+      }
    };
 }
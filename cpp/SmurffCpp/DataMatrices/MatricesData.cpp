@@ -54,6 +54,17 @@ void MatricesData::init_pre()
    }
 }
 
+void MatricesData::setArenas(std::shared_ptr<thread_vector<ScratchArena> > arenas)
+{
+   Data::setArenas(arenas);
+
+   // blocks share the arenas of the session
+   for(auto &p : blocks)
+   {
+      p.data()->setArenas(arenas);
+   }
+}
+
 void MatricesData::init_post()
 {
    Data::init_post();
@@ -76,6 +87,11 @@ double MatricesData::sumsq(const SubModel& model) const
    THROWERROR_NOTIMPL();
 }
 
+double MatricesData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   THROWERROR_NOTIMPL();
+}
+
 double MatricesData::var_total() const
 {
    return NAN;
@@ -109,6 +125,13 @@ void MatricesData::update(const SubModel &model)
    }
 }
 
+void MatricesData::update_sumsq(const SubModel& model, uint32_t mode, int pos)
+{
+   apply(mode, pos, [&model, mode, pos](const Block &b) {
+       b.data()->update_sumsq(b.submodel(model), mode, pos - b.start(mode));
+   });
+}
+
 void MatricesData::getMuLambda(const SubModel& model, uint32_t mode, int pos, Vector& rr, Matrix& MM) const
 {
    int count = 0;
@@ -120,6 +143,24 @@ void MatricesData::getMuLambda(const SubModel& model, uint32_t mode, int pos, Ve
    THROWERROR_ASSERT(count > 0);
 }
 
+std::uint64_t MatricesData::row_nnz(uint32_t mode, int pos) const
+{
+   std::uint64_t n = 0;
+   apply(mode, pos, [mode, pos, &n](const Block &b) {
+       n += b.data()->row_nnz(mode, pos - b.start(mode));
+   });
+   return n;
+}
+
+std::uint64_t MatricesData::row_nobs(uint32_t mode, int pos) const
+{
+   std::uint64_t n = 0;
+   apply(mode, pos, [mode, pos, &n](const Block &b) {
+       n += b.data()->row_nobs(mode, pos - b.start(mode));
+   });
+   return n;
+}
+
 void MatricesData::update_pnm(const SubModel& model, uint32_t mode)
 {
    for(auto &b : blocks) {
@@ -13,17 +13,21 @@ namespace smurff
       void init_pre() override;
       void init_post() override;
 
+      void setArenas(std::shared_ptr<thread_vector<ScratchArena> > arenas) override;
+
       // add data
       std::shared_ptr<Data> add(const PVec<>& p, std::shared_ptr<Data> data);
 
       // helper functions for noise
       // but
       double sumsq(const SubModel& model) const override;
+      double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
       double var_total() const override;
       double train_rmse(const SubModel& model) const override;
 
       // update noise and precision/mean
       void update(const SubModel& model) override;
+      void update_sumsq(const SubModel& model, uint32_t mode, int d) override;
       void getMuLambda(const SubModel& model, uint32_t mode, int d, Vector& rr, Matrix& MM) const override;
       void update_pnm(const SubModel& model, uint32_t mode) override;
 
@@ -41,6 +45,8 @@ namespace smurff
 
       std::uint64_t    nnz() const override;
       std::uint64_t    nna() const override;
+      std::uint64_t    row_nnz(uint32_t mode, int d) const override;
+      std::uint64_t    row_nobs(uint32_t mode, int d) const override;
       double sum() const override;
       PVec<>   dim() const override;
 
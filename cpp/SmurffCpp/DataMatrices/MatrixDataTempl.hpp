@@ -3,6 +3,8 @@
 #include <memory>
 
 #include "MatrixData.h"
+#include "DualSparseMatrix.h"
+#include "SparsePattern.h"
 
 #include <SmurffCpp/Utils/Error.h>
 
@@ -37,6 +39,11 @@ namespace smurff
          return Y().nonZeros(); 
       }
 
+      std::uint64_t row_nnz(uint32_t mode, int d) const override
+      {
+         return Y(mode).cols();
+      }
+
       double sum() const override 
       { 
          return Y().sum(); 
@@ -48,4 +55,95 @@ namespace smurff
          return m_Yv.at(mode);
       }
    };
+
+   // sparse data is stored once, both modes share the values
+   template<>
+   class MatrixDataTempl<SparseMatrix> : public MatrixData
+   {
+   private:
+      DualSparseMatrix m_Y;
+
+   public:
+      MatrixDataTempl(SparseMatrix Y)
+         : m_Y(std::move(Y))
+      {
+      }
+
+      void init_pre() override
+      {
+         THROWERROR_ASSERT(nrow() > 0 && ncol() > 0);
+      }
+
+      PVec<> dim() const override 
+      { 
+         return PVec<>({ static_cast<int>(Y().rows()), static_cast<int>(Y().cols()) }); 
+      }
+
+      std::uint64_t nnz() const override 
+      { 
+         return Y().nonZeros(); 
+      }
+
+      std::uint64_t row_nnz(uint32_t mode, int d) const override
+      {
+         return Y().end(mode, d) - Y().begin(mode, d);
+      }
+
+      double sum() const override 
+      { 
+         return Y().sum(); 
+      }
+
+   public:
+      // use the mode-aware accessors of DualSparseMatrix for mode 1
+      const DualSparseMatrix& Y() const
+      {
+         return m_Y;
+      }
+   };
+
+   // binary data only has the structure, every non-zero is 1
+   template<>
+   class MatrixDataTempl<SparsePattern> : public MatrixData
+   {
+   private:
+      SparsePattern m_Y;
+
+   public:
+      MatrixDataTempl(SparsePattern Y)
+         : m_Y(std::move(Y))
+      {
+      }
+
+      void init_pre() override
+      {
+         THROWERROR_ASSERT(nrow() > 0 && ncol() > 0);
+      }
+
+      PVec<> dim() const override 
+      { 
+         return PVec<>({ static_cast<int>(Y().rows()), static_cast<int>(Y().cols()) }); 
+      }
+
+      std::uint64_t nnz() const override 
+      { 
+         return Y().nonZeros(); 
+      }
+
+      std::uint64_t row_nnz(uint32_t mode, int d) const override
+      {
+         return Y().end(mode, d) - Y().begin(mode, d);
+      }
+
+      double sum() const override 
+      { 
+         return Y().nonZeros(); 
+      }
+
+   public:
+      const SparsePattern& Y() const
+      {
+         return m_Y;
+      }
+   };
 }
@@ -3,10 +3,18 @@
 #include <SmurffCpp/VMatrixExprIterator.hpp>
 #include <SmurffCpp/ConstVMatrixExprIterator.hpp>
 
-#include <SmurffCpp/Utils/ThreadVector.hpp>
+#include <SmurffCpp/Utils/omp_util.h>
+#include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Noises/NoiseSampler.hpp>
 
 namespace smurff {
 
+// rows with at least this many observations use the gather-and-SYRK kernel
+const int ScarceMatrixData::syrk_min_nnz = 16;
+
+// number of gathered V rows per rank-k update
+const int ScarceMatrixData::syrk_panel_size = 256;
+
 ScarceMatrixData::ScarceMatrixData(SparseMatrix Y)
    : MatrixDataTempl<SparseMatrix >(Y)
 {
@@ -20,11 +28,10 @@ void ScarceMatrixData::init_pre()
    // check no rows, nor cols withouth data
    for(std::uint64_t mode = 0; mode < nmode(); ++mode)
    {
-      auto& m = this->Y(mode);
       auto& count = num_empty[mode];
-      for (int j = 0; j < m.rows(); j++)
+      for (int j = 0; j < Y().nouter(mode); j++)
       {
-         if (m.row(j).nonZeros() == 0) 
+         if (Y().begin(mode, j) == Y().end(mode, j)) 
             count++;
       }
    }
@@ -45,29 +52,67 @@ std::ostream& ScarceMatrixData::info(std::ostream& os, std::string indent)
 
 void ScarceMatrixData::getMuLambda(const SubModel& model, std::uint32_t mode, int n, Vector& rr, Matrix& MM) const
 {
-   auto &Y = this->Y(mode);
+   auto &Y = this->Y();
    const int num_latent = model.nlatent();
-   const std::int64_t local_nnz = Y.row(n).nonZeros();
+   const int from = Y.begin(mode, n);
+   const int to = Y.end(mode, n);
+   const std::int64_t local_nnz = to - from;
    const std::int64_t total_nnz = Y.nonZeros();
-   auto from = Y.outerIndexPtr()[n];
-   auto to = Y.outerIndexPtr()[n+1];
 
-   auto getMuLambdaBasic = [&model, this, mode, n](int from, int to, Vector& rr, Matrix& MM) -> void
+   auto getMuLambdaBasic = [&model, this, mode, n](int from, int to, Eigen::Ref<Vector> rr, Eigen::Ref<Matrix> MM) -> void
    {
-       auto &Y = this->Y(mode);
+       auto &Y = this->Y();
        auto Vf = *model.CVbegin(mode);
        auto &ns = noise();
-
-       for(int i = from; i < to; ++i)
-       {
-           auto val = Y.valuePtr()[i];
-           auto idx = Y.innerIndexPtr()[i];
-           const auto &row = Vf.row(idx);
-           auto pos = this->pos(mode, n, idx);
-           double noisy_val = ns.sample(model, pos, val);
-           rr.noalias() += row * noisy_val;
-           MM.triangularView<Eigen::Lower>() +=  ns.getAlpha() * row.transpose() * row;
-       }
+       const double alpha = ns.getAlpha();
+
+       with_sampler(ns, [&](const auto &sample) {
+          if (to - from < syrk_min_nnz)
+          {
+              // short rows: rank-1 update per non-zero
+              for(int i = from; i < to; ++i)
+              {
+                  auto val = Y.value(mode, i);
+                  auto idx = Y.index(mode, i);
+                  const auto &row = Vf.row(idx);
+                  double noisy_val = sample(model, [&]() { return this->pos(mode, n, idx); }, val);
+                  rr.noalias() += row * noisy_val;
+                  MM.triangularView<Eigen::Lower>() +=  alpha * row.transpose() * row;
+              }
+          }
+          else
+          {
+              // long rows: gather the observed rows of V into a contiguous panel,
+              // scaled by sqrt(alpha), and update MM with one symmetric rank-k
+              // product (SYRK) and rr with one GEMV per panel
+              const double sqrt_alpha = std::sqrt(alpha);
+              const int panel_rows = std::min(to - from, syrk_panel_size);
+              const auto U = model.U(mode);
+              ScratchArena &arena = this->arena();
+              ScratchArena::Frame frame(arena);
+              auto panel = arena.matrix(panel_rows, Vf.cols());
+              auto vals = arena.vector(panel_rows);
+              auto noisy_vals = arena.vector(panel_rows);
+
+              for(int p = from; p < to; p += panel_rows)
+              {
+                  const int prows = std::min(panel_rows, to - p);
+                  for(int i = 0; i < prows; ++i)
+                  {
+                      vals(i) = Y.value(mode, p + i);
+                      panel.row(i) = sqrt_alpha * Vf.row(Y.index(mode, p + i));
+                  }
+
+                  const auto &P = panel.topRows(prows);
+                  sample_panel(sample, model, P, U.row(n), vals.head(prows), noisy_vals.head(prows),
+                               [&](int i) { return this->pos(mode, n, Y.index(mode, p + i)); });
+                  noisy_vals.head(prows) /= sqrt_alpha;
+
+                  rr.noalias() += noisy_vals.head(prows) * P;
+                  MM.selfadjointView<Eigen::Lower>().rankUpdate(P.transpose());
+              }
+          }
+       });
 
        // make MM complete
        MM.triangularView<Eigen::Upper>() = MM.transpose();
@@ -76,27 +121,42 @@ void ScarceMatrixData::getMuLambda(const SubModel& model, std::uint32_t mode, in
    
 
    bool in_parallel = (local_nnz >10000) || ((double)local_nnz > (double)total_nnz / 100.);
+   ScratchArena &arena = this->arena();
+   ScratchArena::Frame frame(arena);
    if (in_parallel) 
    {
+       // one partial rr and MM per thread, taken from the arena of this thread
        const int task_size = ceil(local_nnz / 100.0);
-       thread_vector<Vector> rrs(Vector::Zero(num_latent));
-       thread_vector<Matrix> MMs(Matrix::Zero(num_latent, num_latent));
+       const int nthreads = threads::get_max_threads();
+       auto rrs = arena.matrix(nthreads, num_latent);
+       auto MMs = arena.matrix(nthreads * num_latent, num_latent);
+       rrs.setZero();
+       MMs.setZero();
 
        for(int j = from; j < to; j += task_size) 
        {
            #pragma omp task shared(rrs, MMs)
-           getMuLambdaBasic(j, std::min(j + task_size, to), rrs.local(), MMs.local());
+           {
+              ALLOC_COUNTER("sample_latents");
+              const int t = threads::get_thread_num();
+              getMuLambdaBasic(j, std::min(j + task_size, to), rrs.row(t), MMs.middleRows(t * num_latent, num_latent));
+           }
        }
        #pragma omp taskwait
        
        // accumulate 
-       MM += MMs.combine();
-       rr += rrs.combine();
+       for (int t = 0; t < nthreads; t++)
+       {
+          MM += MMs.middleRows(t * num_latent, num_latent);
+          rr += rrs.row(t);
+       }
    } 
    else 
    {
-      Vector my_rr = Vector::Zero(num_latent);
-      Matrix my_MM = Matrix::Zero(num_latent, num_latent);
+      auto my_rr = arena.vector(num_latent);
+      auto my_MM = arena.matrix(num_latent, num_latent);
+      my_rr.setZero();
+      my_MM.setZero();
 
       getMuLambdaBasic(from, to, my_rr, my_MM);
 
@@ -155,4 +215,18 @@ double ScarceMatrixData::sumsq(const SubModel& model) const
 
    return sumsq;
 }
+
+double ScarceMatrixData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   const auto U = model.U(mode);
+   auto Vf = *model.CVbegin(mode);
+   double sumsq = 0.0;
+
+   for (DualSparseMatrix::ModeIterator it(Y(), mode, d); it; ++it)
+   {
+      sumsq += std::pow(U.row(d).dot(Vf.row(it.index())) - it.value(), 2);
+   }
+
+   return sumsq;
+}
 } // end namespace smurff
@@ -9,6 +9,9 @@ namespace smurff
    private:
       int num_empty[2] = {0,0};
 
+      static const int syrk_min_nnz;
+      static const int syrk_panel_size;
+
    public:
       ScarceMatrixData(SparseMatrix Y);
 
@@ -28,5 +31,6 @@ namespace smurff
       double var_total() const override;
       
       double sumsq(const SubModel& model) const override;
+      double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
    };
 }
@@ -1,5 +1,7 @@
 #include "SparseMatrixData.h"
 
+#include <SmurffCpp/Noises/NoiseSampler.hpp>
+
 namespace smurff {
 
 SparseMatrixData::SparseMatrixData(SparseMatrix Y)
@@ -10,17 +12,18 @@ SparseMatrixData::SparseMatrixData(SparseMatrix Y)
 
 void SparseMatrixData::getMuLambda(const SubModel& model, uint32_t mode, int d, Vector& rr, Matrix& MM) const
 {
-    const auto& Y = this->Y(mode);
+    const auto& Y = this->Y();
     auto Vf = *model.CVbegin(mode);
     auto &ns = noise();
 
-    for (SparseMatrix::InnerIterator it(Y, d); it; ++it) 
-    {
-        const auto &row = Vf.row(it.col());
-        auto p = pos(mode, d, it.col());
-        double noisy_val = ns.sample(model, p, it.value());
-        rr.noalias() += row * noisy_val; // rr = rr + (V[m] * y[d]) * alpha
-    }
+    with_sampler(ns, [&](const auto &sample) {
+        for (DualSparseMatrix::ModeIterator it(Y, mode, d); it; ++it) 
+        {
+            const auto &row = Vf.row(it.index());
+            double noisy_val = sample(model, [&]() { return this->pos(mode, d, it.index()); }, it.value());
+            rr.noalias() += row * noisy_val; // rr = rr + (V[m] * y[d]) * alpha
+        }
+    });
 
     MM.noalias() += ns.getAlpha() * VV[mode]; // MM = MM + VV[m]
 }
@@ -37,17 +40,17 @@ double SparseMatrixData::var_total() const
    double se = 0.0;
 
    #pragma omp parallel for schedule(guided) reduction(+:se)
-   for(int c = 0; c < Y().outerSize(); ++c)
+   for(int r = 0; r < Y().outerSize(); ++r)
    {
-      int r = 0;
-      for (SparseMatrix::InnerIterator it(Y(), c); it; ++it)
+      int c = 0;
+      for (SparseMatrix::InnerIterator it(Y(), r); it; ++it)
       {
-         se += (r - it.row()) * cwise_mean_squared; // handle implicit zeroes
+         se += (it.col() - c) * cwise_mean_squared; // handle implicit zeroes
          se += std::pow(it.value() - cwise_mean, 2);
-         r = it.row() + 1;
+         c = it.col() + 1;
       }
 
-      se += (r - Y().rows()) * cwise_mean_squared; // handle implicit zeroes
+      se += (Y().cols() - c) * cwise_mean_squared; // handle implicit zeroes
    }
 
    double var = se / this->size();
@@ -60,29 +63,44 @@ double SparseMatrixData::var_total() const
    return var;
 }
 
+// ||U * V^T - Y||^2 = trace((U^T * U) * (V^T * V)) - 2 * sum_nnz y * (u . v) + sum_nnz y^2
+//
+// implicit zeroes only contribute to the first term, so the cost is
+// O((nrows + ncols) * K^2 + nnz * K) instead of O(nrows * ncols * K)
 double SparseMatrixData::sumsq(const SubModel& model) const
 {
-   double sumsq = 0.0;
-   
+   const auto U = model.U(0);
+   const auto V = model.U(1);
+   double cross = 0.0;
+   double ysq = 0.0;
+
    THROWERROR_ASSERT(Y().IsRowMajor);
-   #pragma omp parallel for schedule(guided) reduction(+:sumsq)
+   #pragma omp parallel for schedule(guided) reduction(+:cross,ysq)
    for(int r = 0; r < Y().outerSize(); ++r) // rows
    {
-      int c = 0;
       for (SparseMatrix::InnerIterator it(Y(), r); it; ++it) // cols
       {
-         for(; c < it.col(); c++) //handle implicit zeroes
-            sumsq += std::pow(model.predict({r, c}), 2);
-
-         // actual non-zero
-         sumsq += std::pow(model.predict({r, c}) - it.value(), 2);
-         c++;
+         cross += it.value() * U.row(r).dot(V.row(it.col()));
+         ysq += it.value() * it.value();
       }
+   }
 
-      for(; c < Y().cols(); c++) //handle implicit zeroes
-         sumsq += std::pow(model.predict({r, c}), 2);
+   // guard against round-off when the fit is (almost) perfect
+   return std::max(0.0, sumsq_pred(model) - 2.0 * cross + ysq);
+}
+
+// same closed form for one row, VV[mode] was cached by update_pnm
+double SparseMatrixData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   const auto U = model.U(mode);
+   auto Vf = *model.CVbegin(mode);
+   double sumsq = (U.row(d) * VV[mode]).dot(U.row(d));
+
+   for (DualSparseMatrix::ModeIterator it(Y(), mode, d); it; ++it)
+   {
+      sumsq += it.value() * (it.value() - 2.0 * U.row(d).dot(Vf.row(it.index())));
    }
 
-   return sumsq;
+   return std::max(0.0, sumsq);
 }
 } // end namespace smurff
@@ -18,5 +18,6 @@ namespace smurff
       double var_total() const override;
       
       double sumsq(const SubModel& model) const override;
+      double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
   };
 }
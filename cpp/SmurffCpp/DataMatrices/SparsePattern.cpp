@@ -0,0 +1,36 @@
+#include "SparsePattern.h"
+
+namespace smurff {
+
+SparsePattern::SparsePattern(const SparseMatrix &Y)
+   : m_rows(Y.rows()), m_cols(Y.cols())
+{
+   // mode 0: copy the structure of each row
+   m_ptr[0].assign(m_rows + 1, 0);
+   m_idx[0].reserve(Y.nonZeros());
+   for (Index r = 0; r < Y.outerSize(); r++)
+   {
+      for (SparseMatrix::InnerIterator it(Y, r); it; ++it)
+         m_idx[0].push_back(it.col());
+      m_ptr[0][r + 1] = m_idx[0].size();
+   }
+
+   const Index nnz = m_idx[0].size();
+
+   // mode 1: count non-zeros per column, then scatter the rows in order
+   m_ptr[1].assign(m_cols + 1, 0);
+   for (Index i = 0; i < nnz; i++)
+      m_ptr[1][m_idx[0][i] + 1]++;
+
+   for (Index c = 0; c < m_cols; c++)
+      m_ptr[1][c + 1] += m_ptr[1][c];
+
+   m_idx[1].resize(nnz);
+   std::vector<StorageIndex> next(m_ptr[1].begin(), m_ptr[1].end() - 1);
+   for (Index r = 0; r < m_rows; r++)
+   {
+      for (Index i = m_ptr[0][r]; i < m_ptr[0][r + 1]; i++)
+         m_idx[1][next[m_idx[0][i]]++] = r;
+   }
+}
+} // end namespace smurff
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+
+#include <SmurffCpp/Types.h>
+
+namespace smurff
+{
+   // Non-zero structure of a sparse matrix, without values.
+   //
+   // Used for binary data, where every non-zero is 1. The structure is
+   // stored twice, by row (mode 0) and by column (mode 1), which still
+   // takes less memory than one copy of the values.
+   class SparsePattern
+   {
+   public:
+      typedef Eigen::Index Index;
+      typedef SparseMatrix::StorageIndex StorageIndex;
+
+   private:
+      Index m_rows;
+      Index m_cols;
+      std::vector<StorageIndex> m_ptr[2]; // [nouter + 1] offsets of each row in mode
+      std::vector<StorageIndex> m_idx[2]; // [nnz] column (mode 0) or row (mode 1) of each non-zero
+
+   public:
+      // values of Y are ignored
+      SparsePattern(const SparseMatrix &Y = SparseMatrix());
+
+   public:
+      Index rows() const { return m_rows; }
+      Index cols() const { return m_cols; }
+      Index nonZeros() const { return m_idx[0].size(); }
+
+      // number of rows in mode
+      Index nouter(int mode) const
+      {
+         return m_ptr[mode].size() - 1;
+      }
+
+      // non-zeros of row n in mode are [begin(mode, n), end(mode, n))
+      Index begin(int mode, Index n) const
+      {
+         return m_ptr[mode][n];
+      }
+
+      Index end(int mode, Index n) const
+      {
+         return m_ptr[mode][n + 1];
+      }
+
+      // column (mode 0) or row (mode 1) of non-zero i
+      StorageIndex index(int mode, Index i) const
+      {
+         return m_idx[mode][i];
+      }
+
+   public:
+      // iterates over the non-zeros of row n in mode
+      class ModeIterator
+      {
+      private:
+         const StorageIndex *m_pos;
+         const StorageIndex *m_end;
+
+      public:
+         ModeIterator(const SparsePattern &Y, int mode, Index n)
+            : m_pos(Y.m_idx[mode].data() + Y.begin(mode, n)), m_end(Y.m_idx[mode].data() + Y.end(mode, n))
+         {
+         }
+
+         ModeIterator &operator++() { m_pos++; return *this; }
+         operator bool() const { return m_pos < m_end; }
+
+         StorageIndex index() const { return *m_pos; }
+         float_type value() const { return 1.0; }
+      };
+   };
+}
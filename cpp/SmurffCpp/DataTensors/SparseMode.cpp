@@ -8,82 +8,48 @@
 namespace smurff {
 
 SparseMode::SparseMode() 
-: m_mode(0) 
+: m_mode(0)
 {
 }
 
-// idx - [nnz x nmodes] matrix of coordinates
-// vals - vector of values
-// m - index of dimension to fix
-// mode_size - size of dimension to fix
-SparseMode::SparseMode(const MatrixXui32& idx, const std::vector<double>& vals, std::uint64_t mode, std::uint64_t mode_size) 
+// store - coordinates and values of all items
+// mode - index of dimension to fix
+SparseMode::SparseMode(std::shared_ptr<const TensorStore> store, std::uint64_t mode) 
+   : m_mode(mode), m_store(store)
 {
-   if ((size_t)idx.rows() != vals.size())
-   {
-      THROWERROR("Number of rows in 'idx' should equal number of values in 'vals'");
-   }
+   const std::uint64_t mode_size = m_store->getDims().at(m_mode);
+   const std::uint64_t nnz = m_store->getNNZ();
 
    m_row_ptr.resize(mode_size + 1); // mode_size + 1 because this vector will hold commulative sum of number of elements
-   m_values.resize(vals.size()); // resize values vector
-   m_indices.resize(idx.rows(), idx.cols() - 1); // reduce number of columns by 1 (exclude fixed dimension)
-
-   m_mode = mode; // save dimension index that is fixed
-   std::uint64_t nnz  = idx.rows(); // get nnz from index matrix
 
-   auto rows = idx.col(m_mode); // get column with coordinates for fixed dimension
-   
    // compute number of non-zero entries per each element for the mode
    // (compute number of non-zero elements for each coordinate in specific dimension)
-   for (std::uint64_t i = 0; i < nnz; i++) 
+   for (std::uint64_t k = 0; k < nnz; k++) 
    {
-      if (rows(i) >= mode_size) //index in column should be within dimension size
-      {
-         THROWERROR("'idx' value is larger than 'mode_size'");
-      }
-
-      m_row_ptr[rows(i)]++; //count item with specific index
+      m_row_ptr[m_store->coord(m_mode, k) + 1]++; //count item with specific index
    }
 
    // compute commulative sum of number of elements for each coordinate in specific dimension
-   for (std::uint64_t row = 0, cumsum = 0; row < mode_size; row++)
+   for (std::uint64_t row = 0; row < mode_size; row++)
    {
-      std::uint64_t temp = m_row_ptr[row];
-      m_row_ptr[row] = cumsum;
-      cumsum += temp;
+      m_row_ptr[row + 1] += m_row_ptr[row];
    }
-   m_row_ptr[mode_size] = nnz; //last element should be equal to nnz
 
-   // transform index matrix into index matrix with one reduced/fixed dimension
-   for (std::uint64_t i = 0; i < nnz; i++) 
-   {
-      std::uint32_t row  = rows(i); // coordinate in fixed dimension
-      std::uint64_t dest = m_row_ptr[row]; // commulative number of elements for this index
-
-      for (std::uint64_t j = 0, nj = 0; j < (std::uint64_t)idx.cols(); j++) //go through each column in index matrix
-      {
-         if (j == m_mode) //skip fixed dimension
-            continue;
-
-         m_indices(dest, nj) = idx(i, j);
-         nj++;
-      }
-
-      m_values[dest] = vals[i];
-      m_row_ptr[row]++; //update commulative sum vector
-   }
+   // the store is sorted by mode 0, other modes need a permutation
+   if (m_mode == 0)
+      return;
 
-   // restore commulative row_ptr
-   for (std::uint64_t row = 0, prev = 0; row <= mode_size; row++) 
+   std::vector<std::uint64_t> next(m_row_ptr.begin(), m_row_ptr.end() - 1);
+   m_perm.resize(nnz);
+   for (std::uint64_t k = 0; k < nnz; k++) 
    {
-      std::uint64_t temp = m_row_ptr[row];
-      m_row_ptr[row] = prev;
-      prev = temp;
+      m_perm[next[m_store->coord(m_mode, k)]++] = k;
    }
 }
 
 std::uint64_t SparseMode::getNNZ() const
 { 
-   return m_indices.rows(); 
+   return m_store->getNNZ(); 
 }
 
 std::uint64_t SparseMode::getNPlanes() const
@@ -93,12 +59,12 @@ std::uint64_t SparseMode::getNPlanes() const
 
 std::uint64_t SparseMode::getNCoords() const
 {
-   return m_indices.cols();
+   return m_store->getNModes() - 1;
 }
 
-const std::vector<double>& SparseMode::getValues() const
+bool SparseMode::isBinary() const
 {
-   return m_values;
+   return m_store->isBinary();
 }
 
 std::uint64_t SparseMode::getMode() const
@@ -121,17 +87,13 @@ std::uint64_t SparseMode::nItemsOnPlane(std::uint64_t hyperplane) const
    return endPlane(hyperplane) - beginPlane(hyperplane);
 }
 
-const MatrixXui32& SparseMode::getIndices() const
+const TensorStore &SparseMode::getStore() const
 {
-   return m_indices;
+   return *m_store;
 }
 
 std::pair<PVec<>, double> SparseMode::item(std::uint64_t hyperplane, std::uint64_t item) const
 {
-   std::vector<int> coords(this->getNCoords() + 1); //number of coordinates in sview + 1 dimension that is fixed
-
-   coords[m_mode] = hyperplane; //fixed mode coordinate of current sview is initialized with index of hyperplane
-
    std::uint64_t nItems = this->nItemsOnPlane(hyperplane); //calculate number of items in hyperplane
 
    if(item >= nItems)
@@ -141,37 +103,25 @@ std::pair<PVec<>, double> SparseMode::item(std::uint64_t hyperplane, std::uint64
 
    std::uint64_t itemIndex = this->beginPlane(hyperplane) + item; //select item in hyperplane
 
-   std::uint64_t m = 0;
-   for(std::uint64_t ci = 0; ci < coords.size(); ci++) //go through each coordinate of the item
-   {
-      //if this is not a fixed coordinate
-      if(ci != m_mode)
-         coords[ci] = static_cast<int>(this->getIndices()(itemIndex, m++)); //get item coordinate
-   }
-
-   return std::make_pair(coords, this->getValues()[itemIndex]);
+   return std::make_pair(this->pos(hyperplane, itemIndex), this->value(this->storeIndex(itemIndex)));
 }
 
 PVec<> SparseMode::pos(std::uint64_t hyperplane, std::uint64_t item) const
 {
    std::vector<int> coords(this->getNCoords() + 1); //number of coordinates in sview + 1 dimension that is fixed
 
-   coords[m_mode] = hyperplane; //fixed mode coordinate of current sview is initialized with index of hyperplane
-
-   std::uint64_t planeStart = this->beginPlane(hyperplane); //get start of a block in indices matrix that corresponds to selected hyperplane
-   std::uint64_t planeEnd = this->endPlane(hyperplane); //get end of a block in indices matrix that corresponds to selected hyperplane
+   std::uint64_t planeStart = this->beginPlane(hyperplane); //get start of a block of items that corresponds to selected hyperplane
+   std::uint64_t planeEnd = this->endPlane(hyperplane); //get end of a block of items that corresponds to selected hyperplane
 
    if(item < planeStart || item >= planeEnd)
    {
       THROWERROR("Wrong item index");
    }
 
-   std::uint64_t m = 0;
+   std::uint64_t k = this->storeIndex(item);
    for(std::uint64_t ci = 0; ci < coords.size(); ci++) //go through each coordinate of the item
    {
-      //if this is not a fixed coordinate
-      if(ci != m_mode)
-         coords[ci] = static_cast<int>(this->getIndices()(item, m++)); //get item coordinate
+      coords[ci] = static_cast<int>(m_store->coord(ci, k)); //the fixed coordinate equals hyperplane
    }
 
    return coords;
@@ -9,28 +9,28 @@
 
 #include <SmurffCpp/Utils/PVec.hpp>
 
-namespace smurff {
+#include "TensorStore.h"
 
-typedef Eigen::Matrix<std::uint32_t, Eigen::Dynamic, Eigen::Dynamic > MatrixXui32;
+namespace smurff {
 
 //this is a tensor rotation where one dimension is fixed (excluded)
+//coordinates and values are shared with the other rotations through the TensorStore,
+//a rotation only keeps the order of the items for its mode
 class SparseMode
 {
 private:
    std::uint64_t m_mode; // index of dimension that it fixed
 
-   std::vector<std::uint64_t> m_row_ptr; // vector of offsets (in values and in indices) to each hyperplane
-   MatrixXui32 m_indices; // [m_nnz x (m_nmodes - 1)] matrix of coordinates
-   std::vector<double> m_values; // vector of values
+   std::shared_ptr<const TensorStore> m_store; // coordinates and values of all items
+   std::vector<std::uint64_t> m_row_ptr; // vector of offsets (in m_perm) to each hyperplane
+   std::vector<std::uint32_t> m_perm; // [m_nnz] position in the store of each item, empty for mode 0
    
 public:
    SparseMode();
 
-   // idx - [nnz x nmodes] matrix of coordinates
-   // vals - vector of values
+   // store - coordinates and values of all items
    // mode - index of dimension to fix
-   // mode_size - size of dimension to fix
-   SparseMode(const MatrixXui32& idx, const std::vector<double>& vals, std::uint64_t mode, std::uint64_t mode_size);
+   SparseMode(std::shared_ptr<const TensorStore> store, std::uint64_t mode);
 
    std::uint64_t getNNZ() const;
 
@@ -38,7 +38,7 @@ public:
 
    std::uint64_t getNCoords() const;
 
-   const std::vector<double>& getValues() const;
+   bool isBinary() const;
 
    std::uint64_t getMode() const;
 
@@ -48,7 +48,25 @@ public:
 
    std::uint64_t nItemsOnPlane(std::uint64_t hyperplane) const;
 
-   const MatrixXui32& getIndices() const;
+   const TensorStore &getStore() const;
+
+   // position in the store of item j, the store is sorted by mode 0
+   std::uint64_t storeIndex(std::uint64_t j) const
+   {
+      return m_perm.empty() ? j : m_perm[j];
+   }
+
+   // coordinate m (excluding the fixed dimension) of the item at store position k
+   std::uint32_t coord(std::uint64_t k, std::uint64_t m) const
+   {
+      return m_store->coord(m < m_mode ? m : m + 1, k);
+   }
+
+   // value of the item at store position k
+   double value(std::uint64_t k) const
+   {
+      return m_store->value(k);
+   }
 
 public:
    std::pair<PVec<>, double> item(std::uint64_t hyperplane, std::uint64_t item) const;
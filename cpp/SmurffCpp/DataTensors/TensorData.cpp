@@ -5,71 +5,43 @@
 #include <iomanip>
 
 #include <SmurffCpp/ConstVMatrixExprIterator.hpp>
+#include <SmurffCpp/Noises/NoiseSampler.hpp>
 
 namespace smurff {
 
-//convert array of coordinates to [nnz x nmodes] matrix
-static MatrixXui32 toMatrixNew(const DenseTensor &tc)
-{
-   std::uint64_t nnz = tc.getNNZ();
-   std::uint64_t nmodes = tc.getNModes();
-   MatrixXui32 idx(nnz, nmodes);
-
-   std::uint64_t c = 0;
-   for (auto it = PVecIterator(tc.getDims()); !it.done(); ++it, c++)
-      for (unsigned d = 0; d < tc.getNModes(); ++d)
-            idx(c, d) = (*it).at(d);
-
-
-   return idx;
-}
-
-//convert array of coordinates to [nnz x nmodes] matrix
-static MatrixXui32 toMatrixNew(const SparseTensor &tc)
-{
-   std::uint64_t nnz = tc.getNNZ();
-   std::uint64_t nmodes = tc.getNModes();
-   MatrixXui32 idx(nnz, nmodes);
-
-   std::vector<std::vector<std::uint32_t>> columns(nmodes);
-   for (std::uint64_t col = 0; col < nmodes; col++)
-      for (std::uint64_t row = 0; row < nnz; row++)
-         idx(row, col) = tc.getColumn(col)[row];
-
-   return idx;
-}
+const int TensorData::kr_panel_size = 256;
 
 TensorData::TensorData(const DenseTensor& ts) 
    : m_dims(ts.getDims()),
      m_nnz(ts.getNNZ()),
      m_Y(std::make_shared<std::vector<std::shared_ptr<SparseMode> > >())
 {
-   //combine coordinates into [nnz x nmodes] matrix
-   MatrixXui32 idx = toMatrixNew(ts);
+   //coordinates and values are stored once, each mode keeps its own order
+   auto store = std::make_shared<const TensorStore>(ts);
 
    for (std::uint64_t mode = 0; mode < ts.getNModes(); mode++) 
    {
-      m_Y->push_back(std::make_shared<SparseMode>(idx, ts.getValues(), mode, m_dims[mode]));
+      m_Y->push_back(std::make_shared<SparseMode>(store, mode));
    }
 
    this->name = "DenseTensorData";
 }
 
 
-TensorData::TensorData(const SparseTensor& ts) 
+TensorData::TensorData(const SparseTensor& ts, bool binary) 
    : m_dims(ts.getDims()),
      m_nnz(ts.getNNZ()),
      m_Y(std::make_shared<std::vector<std::shared_ptr<SparseMode> > >())
 {
-   //combine coordinates into [nnz x nmodes] matrix
-   MatrixXui32 idx = toMatrixNew(ts);
+   //coordinates and values are stored once, each mode keeps its own order
+   auto store = std::make_shared<const TensorStore>(ts, binary);
 
    for (std::uint64_t mode = 0; mode < ts.getNModes(); mode++) 
    {
-      m_Y->push_back(std::make_shared<SparseMode>(idx, ts.getValues(), mode, m_dims[mode]));
+      m_Y->push_back(std::make_shared<SparseMode>(store, mode));
    }
 
-   this->name = "SparseTensorData";
+   this->name = binary ? "BinaryTensorData" : "SparseTensorData";
 }
 
 
@@ -89,13 +61,15 @@ double TensorData::sum() const
    double esum = 0.0;
 
    std::shared_ptr<SparseMode> sview = Y(0);
+   if (sview->isBinary())
+      return this->nnz();
 
    #pragma omp parallel for schedule(guided) reduction(+:esum)
    for(std::uint64_t n = 0; n < sview->getNPlanes(); n++) //go through each hyperplane
    {
       for(std::uint64_t j = sview->beginPlane(n); j < sview->endPlane(n); j++) //go through each item in the plane
       {
-         esum += sview->getValues()[j];
+         esum += sview->value(j); //mode 0 is in store order
       }
    }
 
@@ -117,6 +91,11 @@ std::uint64_t TensorData::nna() const
    return size() - this->nnz();
 }
 
+std::uint64_t TensorData::row_nnz(uint32_t mode, int d) const
+{
+   return Y(mode)->nItemsOnPlane(d);
+}
+
 PVec<> TensorData::dim() const
 {
    std::vector<int> pvec_dims;
@@ -130,30 +109,79 @@ double TensorData::train_rmse(const SubModel& model) const
    return std::sqrt(sumsq(model) / this->nnz());
 }
 
+TensorData::KhatriRaoScratch TensorData::scratch(ScratchArena &arena, const SubModel& model, uint32_t mode, int panel_rows) const
+{
+   const int nV = Y(mode)->getNCoords();
+   KhatriRaoScratch scratch = {
+      arena.allocate<const float_type *>(nV),
+      arena.allocate<std::ptrdiff_t>(nV),
+      arena.matrix(panel_rows, model.nlatent()),
+      arena.vector(panel_rows),
+      arena.vector(panel_rows)
+   };
+
+   int m = 0;
+   for (auto V = model.CVbegin(mode); V != model.CVend(); ++V, ++m)
+   {
+      const auto &Vf = *V;
+      scratch.Vptr[m] = Vf.data();
+      scratch.Vstride[m] = Vf.outerStride();
+   }
+
+   return scratch;
+}
+
 //d is an index of column in U matrix
 //this function selects d'th hyperplane from mode`th SparseMode
-//it does j multiplications
-//where each multiplication is a cwiseProduct of columns from each V matrix
+//for each item j it computes the elementwise product of the matching rows of all V matrices
+//these rows are gathered into a panel, MM gets one rank-k update per panel
 void TensorData::getMuLambda(const SubModel& model, uint32_t mode, int d, Vector& rr, Matrix& MM) const
 {
    std::shared_ptr<SparseMode> sview = Y(mode); //get tensor rotation for mode
-   
-   auto V0 = model.CVbegin(mode); //get first V matrix
-   for (std::uint64_t j = sview->beginPlane(d); j < sview->endPlane(d); j++) //go through hyperplane in tensor rotation
-   {
-      Vector row = (*V0).row(sview->getIndices()(j, 0)); //create a copy of m'th column from V (m = 0)
-      auto V = model.CVbegin(mode); //get V matrices for mode      
-      for (std::uint64_t m = 1; m < sview->getNCoords(); m++) //go through each coordinate of value
+   const std::uint64_t ncoords = sview->getNCoords();
+   const std::uint64_t from = sview->beginPlane(d);
+   const std::uint64_t to = sview->endPlane(d);
+   const int num_latent = model.nlatent();
+
+   auto &ns = noise();
+   const double sqrt_alpha = std::sqrt(ns.getAlpha());
+
+   //fetch V matrices once per hyperplane
+   ScratchArena::Frame frame(arena());
+   const int panel_rows = static_cast<int>(std::min<std::uint64_t>(kr_panel_size, std::max<std::uint64_t>(to - from, 1)));
+   KhatriRaoScratch scratch = this->scratch(arena(), model, mode, panel_rows);
+
+   typedef Eigen::Map<const Array1D> RowMap;
+
+   // binary data has no values to gather
+   if (sview->isBinary())
+      scratch.vals.setOnes();
+
+   with_sampler(ns, [&](const auto &sample) {
+      for (std::uint64_t p = from; p < to; p += panel_rows)
       {
-         ++V; //inc iterator prior to access since we are starting from m = 1
-         row.noalias() = row.cwiseProduct((*V).row(sview->getIndices()(j, m))); //multiply by m'th column from V
+         const int prows = static_cast<int>(std::min<std::uint64_t>(panel_rows, to - p));
+         for (int i = 0; i < prows; ++i)
+         {
+            const std::uint64_t k = sview->storeIndex(p + i);
+            auto row = scratch.panel.row(i).array();
+            row = sqrt_alpha * RowMap(scratch.Vptr[0] + sview->coord(k, 0) * scratch.Vstride[0], num_latent);
+            for (std::uint64_t m = 1; m < ncoords; m++)
+               row *= RowMap(scratch.Vptr[m] + sview->coord(k, m) * scratch.Vstride[m], num_latent);
+
+            if (!sview->isBinary())
+               scratch.vals(i) = sview->value(k);
+         }
+
+         const auto &P = scratch.panel.topRows(prows);
+         sample_panel(sample, model, P, model.U(mode).row(d), scratch.vals.head(prows), scratch.noisy_vals.head(prows),
+                      [&](int i) { return sview->pos(d, p + i); });
+         scratch.noisy_vals.head(prows) /= sqrt_alpha;
+
+         rr.noalias() += scratch.noisy_vals.head(prows) * P; // rr = rr + (row * value) * alpha (where row = product of rows in each V)
+         MM.selfadjointView<Eigen::Lower>().rankUpdate(P.transpose()); // MM = MM + (row * rowT) * alpha
       }
-      MM.triangularView<Eigen::Lower>() += noise().getAlpha() * row.transpose() * row; // MM = MM + (row * colT) * alpha (where row = product of columns in each V)
-      
-      auto pos = sview->pos(d, j);
-      double noisy_val = noise().sample(model, pos, sview->getValues()[j]);
-      rr.noalias() += row * noisy_val; // rr = rr + (row * value) * alpha (where value = j'th value of Y)
-   }
+   });
 
    MM.triangularView<Eigen::Upper>() = MM.transpose();
 }
@@ -183,6 +211,32 @@ double TensorData::sumsq(const SubModel& model) const
    return sumsq;
 }
 
+double TensorData::sumsq_row(const SubModel& model, uint32_t mode, int d) const
+{
+   std::shared_ptr<SparseMode> sview = Y(mode);
+   const int num_latent = model.nlatent();
+   const auto U = model.U(mode);
+
+   ScratchArena::Frame frame(arena());
+   KhatriRaoScratch scratch = this->scratch(arena(), model, mode, 1);
+   auto row = scratch.panel.row(0).array();
+
+   typedef Eigen::Map<const Array1D> RowMap;
+
+   double sumsq = 0.0;
+   for (std::uint64_t j = sview->beginPlane(d); j < sview->endPlane(d); j++)
+   {
+      const std::uint64_t k = sview->storeIndex(j);
+      row = U.row(d).array() * RowMap(scratch.Vptr[0] + sview->coord(k, 0) * scratch.Vstride[0], num_latent);
+      for (std::uint64_t m = 1; m < sview->getNCoords(); m++)
+         row *= RowMap(scratch.Vptr[m] + sview->coord(k, m) * scratch.Vstride[m], num_latent);
+
+      sumsq += std::pow(row.sum() - sview->value(k), 2);
+   }
+
+   return sumsq;
+}
+
 double TensorData::var_total() const
 {
    double cwise_mean = this->sum() / this->nnz();
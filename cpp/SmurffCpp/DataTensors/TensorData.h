@@ -21,9 +21,27 @@ private:
    std::uint64_t m_nnz;
    std::shared_ptr<std::vector<std::shared_ptr<SparseMode> > > m_Y; // this is a vector of tensor rotations
 
+   // scratch buffers for getMuLambda, taken from the arena of the calling thread
+   struct KhatriRaoScratch
+   {
+      const float_type **Vptr; // first row of each V matrix
+      std::ptrdiff_t *Vstride; // distance between rows of each V matrix
+      Eigen::Map<Matrix> panel; // Khatri-Rao rows of one panel, scaled by sqrt(alpha)
+      Eigen::Map<Vector> vals; // values of one panel
+      Eigen::Map<Vector> noisy_vals; // noisy values of one panel, divided by sqrt(alpha)
+   };
+
+   // scratch for panels of panel_rows with the V matrices of mode fetched,
+   // it lives in the current Frame of arena
+   KhatriRaoScratch scratch(ScratchArena &arena, const SubModel& model, uint32_t mode, int panel_rows) const;
+
+   // number of Khatri-Rao rows per rank-k update
+   static const int kr_panel_size;
+
 public:
    TensorData(const smurff::DenseTensor& ts);
-   TensorData(const smurff::SparseTensor& ts);
+   // binary - only keep the coordinates, all values are 1
+   TensorData(const smurff::SparseTensor& ts, bool binary = false);
 
    std::shared_ptr<SparseMode> Y(std::uint64_t mode) const;
 
@@ -37,6 +55,7 @@ public:
    std::uint64_t nmode() const override;
    std::uint64_t nnz() const override;
    std::uint64_t nna() const override;
+   std::uint64_t row_nnz(uint32_t mode, int d) const override;
    PVec<> dim() const override;
 
 public:
@@ -46,6 +65,7 @@ public:
 
 public:
    double sumsq(const SubModel& model) const override;
+   double sumsq_row(const SubModel& model, uint32_t mode, int d) const override;
    double var_total() const override;
 
 public:
@@ -0,0 +1,135 @@
+#include "TensorStore.h"
+
+#include <SmurffCpp/Utils/Error.h>
+
+namespace smurff {
+
+const std::uint64_t TensorStore::max_narrow_size = 1ULL << 16;
+
+TensorStore::TensorStore(const DenseTensor &ts)
+   : m_dims(ts.getDims()),
+     m_nnz(ts.getNNZ()),
+     m_coords16(m_dims.size()),
+     m_coords32(m_dims.size()),
+     m_narrow(m_dims.size()),
+     m_values(ts.getValues()),
+     m_binary(false)
+{
+   THROWERROR_ASSERT_MSG(m_nnz < (1ULL << 32), "Tensor has too many non-zeros");
+
+   // values are in row-major order, so they are already sorted by mode 0
+   std::uint64_t stride = 1;
+   for (std::uint64_t mode = m_dims.size(); mode-- > 0; )
+   {
+      resize(mode);
+      for (std::uint64_t k = 0; k < m_nnz; k++)
+         setCoord(mode, k, (k / stride) % m_dims[mode]);
+
+      stride *= m_dims[mode];
+   }
+}
+
+TensorStore::TensorStore(const SparseTensor &ts, bool binary)
+   : m_dims(ts.getDims()),
+     m_nnz(ts.getNNZ()),
+     m_coords16(m_dims.size()),
+     m_coords32(m_dims.size()),
+     m_narrow(m_dims.size()),
+     m_binary(binary)
+{
+   THROWERROR_ASSERT_MSG(m_nnz < (1ULL << 32), "Tensor has too many non-zeros");
+
+   // counting sort of the items by their mode 0 coordinate
+   const auto &rows = ts.getColumn(0);
+   std::vector<std::uint64_t> row_ptr(m_dims[0] + 1, 0);
+   for (std::uint64_t i = 0; i < m_nnz; i++)
+   {
+      if (rows[i] >= m_dims[0])
+      {
+         THROWERROR("'idx' value is larger than 'mode_size'");
+      }
+
+      row_ptr[rows[i] + 1]++;
+   }
+
+   for (std::uint64_t r = 0; r < m_dims[0]; r++)
+      row_ptr[r + 1] += row_ptr[r];
+
+   std::vector<std::uint32_t> dest(m_nnz);
+   for (std::uint64_t i = 0; i < m_nnz; i++)
+      dest[i] = row_ptr[rows[i]]++;
+
+   for (std::uint64_t mode = 0; mode < m_dims.size(); mode++)
+   {
+      const auto &column = ts.getColumn(mode);
+      resize(mode);
+      for (std::uint64_t i = 0; i < m_nnz; i++)
+      {
+         if (column[i] >= m_dims[mode])
+         {
+            THROWERROR("'idx' value is larger than 'mode_size'");
+         }
+
+         setCoord(mode, dest[i], column[i]);
+      }
+   }
+
+   if (!m_binary)
+   {
+      m_values.resize(m_nnz);
+      for (std::uint64_t i = 0; i < m_nnz; i++)
+         m_values[dest[i]] = ts.getValues()[i];
+   }
+}
+
+void TensorStore::resize(std::uint64_t mode)
+{
+   m_narrow[mode] = m_dims[mode] <= max_narrow_size;
+   if (m_narrow[mode])
+      m_coords16[mode].resize(m_nnz);
+   else
+      m_coords32[mode].resize(m_nnz);
+}
+
+void TensorStore::setCoord(std::uint64_t mode, std::uint64_t k, std::uint32_t c)
+{
+   if (m_narrow[mode])
+      m_coords16[mode][k] = c;
+   else
+      m_coords32[mode][k] = c;
+}
+
+std::uint64_t TensorStore::getNModes() const
+{
+   return m_dims.size();
+}
+
+std::uint64_t TensorStore::getNNZ() const
+{
+   return m_nnz;
+}
+
+const std::vector<std::uint64_t> &TensorStore::getDims() const
+{
+   return m_dims;
+}
+
+bool TensorStore::isBinary() const
+{
+   return m_binary;
+}
+
+bool TensorStore::isNarrow(std::uint64_t mode) const
+{
+   return m_narrow[mode];
+}
+
+std::uint64_t TensorStore::memory() const
+{
+   std::uint64_t bytes = m_values.size() * sizeof(double);
+   for (std::uint64_t mode = 0; mode < m_dims.size(); mode++)
+      bytes += m_coords16[mode].size() * sizeof(std::uint16_t) + m_coords32[mode].size() * sizeof(std::uint32_t);
+
+   return bytes;
+}
+} // end namespace smurff
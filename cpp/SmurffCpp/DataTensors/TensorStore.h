@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <SmurffCpp/Types.h>
+#include <SmurffCpp/Utils/Tensor.h>
+
+namespace smurff {
+
+//coordinates and values of all items of a tensor, stored once and shared by all SparseModes
+//items are sorted by their mode 0 coordinate
+class TensorStore
+{
+private:
+   std::vector<std::uint64_t> m_dims; // vector of dimension sizes
+   std::uint64_t m_nnz;
+
+   // coordinates of each mode, 16 bit if the mode is small enough, else 32 bit
+   std::vector<std::vector<std::uint16_t> > m_coords16;
+   std::vector<std::vector<std::uint32_t> > m_coords32;
+   std::vector<char> m_narrow; // mode uses m_coords16
+
+   std::vector<double> m_values; // vector of values, empty for binary data
+   bool m_binary; // all values are 1
+
+public:
+   // largest mode size with 16 bit coordinates
+   static const std::uint64_t max_narrow_size;
+
+public:
+   TensorStore(const DenseTensor &ts);
+
+   // binary - only keep the coordinates, all values are 1
+   TensorStore(const SparseTensor &ts, bool binary = false);
+
+public:
+   std::uint64_t getNModes() const;
+   std::uint64_t getNNZ() const;
+   const std::vector<std::uint64_t> &getDims() const;
+
+   bool isBinary() const;
+   bool isNarrow(std::uint64_t mode) const;
+
+   // coordinate in mode of item k
+   std::uint32_t coord(std::uint64_t mode, std::uint64_t k) const
+   {
+      return m_narrow[mode] ? m_coords16[mode][k] : m_coords32[mode][k];
+   }
+
+   double value(std::uint64_t k) const
+   {
+      return m_binary ? 1.0 : m_values[k];
+   }
+
+   // bytes used by coordinates and values
+   std::uint64_t memory() const;
+
+private:
+   void resize(std::uint64_t mode);
+   void setCoord(std::uint64_t mode, std::uint64_t k, std::uint32_t c);
+};
+
+}
@@ -13,6 +13,7 @@
 #include <SmurffCpp/Utils/Distribution.h>
 
 #include <SmurffCpp/Model.h>
+#include <SmurffCpp/Aggregate.h>
 
 #include <SmurffCpp/VMatrixIterator.hpp>
 #include <SmurffCpp/ConstVMatrixIterator.hpp>
@@ -32,15 +33,15 @@ Model::Model()
 //num_latent - size of latent dimension
 //dims - dimentions of train data
 //init_model_type - samples initialization type
-void Model::init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_type, bool save_model, bool aggregate)
+void Model::init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_type, bool save_model,
+                 AggregateTypes aggregate, const std::string &spill_name)
 {
    size_t nmodes = dims.size();
 
    m_num_latent = num_latent;
    m_dims = dims;
-   m_collect_aggr = aggregate;
    m_save_model = save_model;
-   m_num_aggr = std::vector<int>(dims.size(), 0);
+   m_aggr.clear();
 
    m_factors.resize(nmodes);
    m_link_matrices.resize(nmodes);
@@ -65,10 +66,10 @@ void Model::init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_t
          }
       }
 
-      if (aggregate)
+      if (aggregate != AggregateTypes::none)
       {
-         m_aggr_sum.push_back(Matrix::Zero(dims[i], m_num_latent));
-         m_aggr_dot.push_back(Matrix::Zero(dims[i], m_num_latent * m_num_latent));
+         const std::string name = spill_name.empty() ? std::string() : spill_name + "_" + std::to_string(i);
+         m_aggr.push_back(std::make_shared<Aggregate>(aggregate, dims[i], m_num_latent, name));
       }
    }
 
@@ -170,19 +171,11 @@ SubModel Model::full()
    return SubModel(*this);
 }
 
-void Model::updateAggr(int m, int i)
-{
-   if (!m_collect_aggr) return;
-
-   const auto &r = row(m, i);
-   Matrix cov = (r.transpose() * r);
-   m_aggr_sum.at(m).row(i) += r;
-   m_aggr_dot.at(m).row(i) += Eigen::Map<Vector>(cov.data(), nlatent() * nlatent());
-}
-
 void Model::updateAggr(int m)
 {
-   m_num_aggr.at(m)++;
+   if (m_aggr.empty()) return;
+
+   m_aggr.at(m)->add(U(m));
 }
 
 void Model::save(SaveState &sf) const
@@ -193,33 +186,9 @@ void Model::save(SaveState &sf) const
       sf.putLinkMatrix(m, m_link_matrices.at(m));
       sf.putMu(m, m_mus.at(m));
 
-      if (m_collect_aggr && sf.saveAggr())
-      {
-         int n = m_num_aggr.at(m);
-         const Matrix &Usum = m_aggr_sum.at(m);
-         const Matrix &Uprod = m_aggr_dot.at(m);
-         if (sf.isCheckpoint())
-            sf.putAggr(m, n, Usum, Uprod);
-         else
-         {
-            // compute mean and precision (inverse of the covariance)
-            Matrix mu = Matrix::Zero(Usum.rows(), Usum.cols());
-            Matrix prec = Matrix::Zero(Uprod.rows(), Uprod.cols());
-
-            // calculate real mu and Lambda
-            for (int i = 0; i < U(m).rows(); i++)
-            {
-               Vector sum = Usum.row(i);
-               Matrix prod = Eigen::Map<const Matrix>(Uprod.row(i).data(), nlatent(), nlatent());
-               Matrix prec_i = ((prod - (sum.transpose() * sum / n)) / (n - 1)).inverse();
-
-               prec.row(i) = Eigen::Map<Vector>(prec_i.data(), nlatent() * nlatent());
-               mu.row(i) = sum / n;
-            }
-
-            sf.putPostMuLambda(m, mu, prec);
-         }
-      }
+      // the sums for checkpoints, posterior mean and precision otherwise
+      if (!m_aggr.empty() && sf.saveAggr())
+         m_aggr.at(m)->save(sf, m);
    }
 }
 
@@ -230,10 +199,6 @@ void Model::restore(const SaveState &sf, int skip_mode)
    m_dims = PVec<>(nmodes);
    m_factors.resize(nmodes);
 
-   m_num_aggr.resize(nmodes);
-   m_aggr_sum.resize(nmodes);
-   m_aggr_dot.resize(nmodes);
-
    for (std::uint64_t i = 0; i < nmodes; ++i)
    {
       if ((int)i != skip_mode)
@@ -243,13 +208,8 @@ void Model::restore(const SaveState &sf, int skip_mode)
          m_dims.at(i) = U.rows();
          m_num_latent = U.cols();
 
-         if (sf.hasAggr(i))
-         {
-            int        &n = m_num_aggr.at(i);
-            Matrix  &Usum = m_aggr_sum.at(i);
-            Matrix &Uprod = m_aggr_dot.at(i);
-            sf.readAggr(i, n, Usum, Uprod);
-         }
+         if (i < m_aggr.size() && sf.hasAggr(i))
+            m_aggr.at(i)->restore(sf, i);
       }
       else
       {
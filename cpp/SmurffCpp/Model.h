@@ -15,6 +15,8 @@ namespace smurff {
 
 class SaveState;
 
+class Aggregate;
+
 class Data;
 
 class SubModel;
@@ -38,10 +40,7 @@ private:
    std::vector<Matrix> m_link_matrices; //vector of ß matrices
    std::vector<Vector> m_mus; //vector of mu vectors
 
-   bool m_collect_aggr;
-   std::vector<Matrix> m_aggr_sum; //vector of aggr summed m_factors matrices
-   std::vector<Matrix> m_aggr_dot; //vector of aggr dot m_factors matrices
-   std::vector<int> m_num_aggr; //number of aggregated samples in above vectors
+   std::vector<std::shared_ptr<Aggregate>> m_aggr; //posterior aggregates per mode, empty when not collected
 
    int m_num_latent; //size of latent dimension for U matrices
    PVec<> m_dims; //dimensions of train data
@@ -54,7 +53,9 @@ public:
 
 public:
    //initialize U matrices in the model (random/zero)
-   void init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_type, bool save_model, bool collect_aggr = true);
+   //spill_name - prefix of the files with the aggregates when aggregate is spill
+   void init(int num_latent, const PVec<>& dims, ModelInitTypes model_init_type, bool save_model,
+             AggregateTypes aggregate = AggregateTypes::none, const std::string &spill_name = std::string());
 
 public:
    Matrix &getLinkMatrix(int mode);
@@ -113,8 +114,8 @@ public:
    SubModel full();
 
 public:
+   // adds the current U of mode m to the aggregates, called after each sweep
    void updateAggr(int m);
-   void updateAggr(int m, int n);
 
 public:
    // output to file
@@ -7,8 +7,8 @@
 
 namespace smurff {
 
-AdaptiveGaussianNoise::AdaptiveGaussianNoise(double sinit, double smax)
-: sn_max(smax), sn_init(sinit)
+AdaptiveGaussianNoise::AdaptiveGaussianNoise(double sinit, double smax, bool fused)
+: sn_max(smax), sn_init(sinit), fused_sumsq(fused), sumsq_rows(0.0)
 {
 
 }
@@ -26,7 +26,7 @@ void AdaptiveGaussianNoise::init(const Data* data)
 
 void AdaptiveGaussianNoise::update(const SubModel& model)
 {
-   double sumsq = data().sumsq(model);
+   double sumsq = fused_sumsq ? sumsq_rows.combine_and_reset() : data().sumsq(model);
 
    // (a0, b0) correspond to a prior of 1 sample of noise with full variance
    double a0 = 0.5;
@@ -41,6 +41,16 @@ void AdaptiveGaussianNoise::update(const SubModel& model)
    }
 }
 
+bool AdaptiveGaussianNoise::fusedSumsq() const
+{
+   return fused_sumsq;
+}
+
+void AdaptiveGaussianNoise::addSumsq(double sumsq)
+{
+   sumsq_rows.local() += sumsq;
+}
+
 std::ostream &AdaptiveGaussianNoise::info(std::ostream &os, std::string indent)
 {
    os << "Adaptive gaussian noise with max precision of " << alpha_max << std::endl;
@@ -63,4 +73,9 @@ void AdaptiveGaussianNoise::setSNMax(double a)
 {
    sn_max  = a;
 }
+
+NoiseTypes AdaptiveGaussianNoise::getNoiseType() const
+{
+   return NoiseTypes::adaptive;
+}
 } // end namespace smurff
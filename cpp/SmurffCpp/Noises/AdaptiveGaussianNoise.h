@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include <SmurffCpp/Noises/GaussianNoise.h>
+#include <SmurffCpp/Utils/ThreadVector.hpp>
 
 #include <SmurffCpp/DataMatrices/Data.h>
 
@@ -22,15 +23,25 @@ namespace smurff {
       double sn_max;
       double sn_init;
 
+   private:
+      // accumulate sumsq during the sweep of the last mode instead of
+      // computing it afterwards with Data::sumsq
+      bool fused_sumsq;
+      thread_vector<double> sumsq_rows;
+
    protected:
-      AdaptiveGaussianNoise(double sinit = 1., double smax = 10.);
+      AdaptiveGaussianNoise(double sinit = 1., double smax = 10., bool fused = false);
 
    public:
       void init(const Data* data) override;
       void update(const SubModel& model) override;
 
+      bool fusedSumsq() const override;
+      void addSumsq(double sumsq) override;
+
       std::ostream &info(std::ostream &os, std::string indent) override;
       std::string getStatus() override;
+      NoiseTypes getNoiseType() const override;
 
       void setSNInit(double a);
       void setSNMax(double a);
@@ -25,4 +25,9 @@ void FixedGaussianNoise::setPrecision(double a)
 {
    alpha = a;
 }
+
+NoiseTypes FixedGaussianNoise::getNoiseType() const
+{
+   return NoiseTypes::fixed;
+}
 } // end namespace smurff
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include <SmurffCpp/Types.h>
+#include <SmurffCpp/Configs/NoiseConfig.h>
 
 #include <SmurffCpp/Utils/PVec.hpp>
 
@@ -38,8 +39,13 @@ namespace smurff {
    public:
       virtual std::ostream &info(std::ostream &os, std::string indent)   = 0;
       virtual std::string getStatus()  = 0;
+      virtual NoiseTypes getNoiseType() const = 0;
 
       virtual double getAlpha() const;
       virtual double sample(const SubModel& model, const PVec<> &pos, double val);
+
+      // fused residual computation, see Data::update_sumsq
+      virtual bool fusedSumsq() const { return false; }
+      virtual void addSumsq(double sumsq) {}
    };
 }
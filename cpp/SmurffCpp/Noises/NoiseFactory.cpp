@@ -19,7 +19,7 @@ std::unique_ptr<INoiseModel> NoiseFactory::create_noise_model(const NoiseConfig&
       case NoiseTypes::sampled:
          return std::unique_ptr<INoiseModel>(new SampledGaussianNoise(config.getPrecision()));
       case NoiseTypes::adaptive:
-         return std::unique_ptr<INoiseModel>(new AdaptiveGaussianNoise(config.getSnInit(), config.getSnMax()));
+         return std::unique_ptr<INoiseModel>(new AdaptiveGaussianNoise(config.getSnInit(), config.getSnMax(), config.getFusedSumsq()));
       case NoiseTypes::probit:
          return std::unique_ptr<INoiseModel>(new ProbitNoise(config.getThreshold()));
       case NoiseTypes::unused:
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SmurffCpp/Noises/INoiseModel.h>
+#include <SmurffCpp/Noises/ProbitNoise.h>
+
+#include <SmurffCpp/Configs/NoiseConfig.h>
+
+namespace smurff {
+
+   // Non-virtual versions of INoiseModel::sample, so that the getMuLambda
+   // kernels can be instantiated per noise type.
+   // pos is a callable returning the PVec of the value; it is only
+   // evaluated by the noise models that need the position.
+
+   // fixed, sampled and adaptive gaussian noise
+   struct GaussianSampler
+   {
+      const double alpha;
+
+      template<typename PosF>
+      double operator()(const SubModel &, PosF &&, double val) const
+      {
+         return alpha * val;
+      }
+   };
+
+   struct ProbitSampler
+   {
+      ProbitNoise &ns;
+
+      template<typename PosF>
+      double operator()(const SubModel &model, PosF &&pos, double val) const
+      {
+         return ns.ProbitNoise::sample(model, pos(), val);
+      }
+   };
+
+   // any other noise model, through the virtual call
+   struct NoiseModelSampler
+   {
+      INoiseModel &ns;
+
+      template<typename PosF>
+      double operator()(const SubModel &model, PosF &&pos, double val) const
+      {
+         return ns.sample(model, pos(), val);
+      }
+   };
+
+   // samples the values of a panel, P holds their rows of V scaled by
+   // sqrt(alpha) and u is the current latent vector of the row
+   template<typename Sampler, typename PType, typename UType, typename PosF>
+   void sample_panel(const Sampler &sample, const SubModel &model, const PType &P, const UType &u,
+                     const Eigen::Ref<const Vector> &vals, Eigen::Ref<Vector> noisy_vals, PosF &&pos)
+   {
+      for (int i = 0; i < vals.size(); ++i)
+         noisy_vals(i) = sample(model, [&]() { return pos(i); }, vals(i));
+   }
+
+   // probit: all predictions in one GEMV and all truncated normals in one batch
+   // alpha is 1, so P is not scaled
+   template<typename PType, typename UType, typename PosF>
+   void sample_panel(const ProbitSampler &sample, const SubModel &, const PType &P, const UType &u,
+                     const Eigen::Ref<const Vector> &vals, Eigen::Ref<Vector> noisy_vals, PosF &&)
+   {
+      const Array1D preds = (P * u.transpose()).transpose().array();
+      Array1D out;
+      sample.ns.sample(vals.array(), preds, out);
+      noisy_vals = out.matrix();
+   }
+
+   // noise models sampled with GaussianSampler: noisy_val = alpha * val
+   inline bool is_gaussian(const INoiseModel &ns)
+   {
+      switch (ns.getNoiseType())
+      {
+         case NoiseTypes::fixed:
+         case NoiseTypes::sampled:
+         case NoiseTypes::adaptive:
+            return true;
+         default:
+            return false;
+      }
+   }
+
+   // calls f once with the sampler matching the type of ns
+   template<typename F>
+   void with_sampler(INoiseModel &ns, F &&f)
+   {
+      if (is_gaussian(ns))
+      {
+         f(GaussianSampler{ns.getAlpha()});
+         return;
+      }
+
+      switch (ns.getNoiseType())
+      {
+         case NoiseTypes::probit:
+            f(ProbitSampler{static_cast<ProbitNoise &>(ns)});
+            break;
+         default:
+            f(NoiseModelSampler{ns});
+            break;
+      }
+   }
+}
@@ -27,6 +27,14 @@ double ProbitNoise::sample(const SubModel& model, const PVec<> &pos, double val)
     return sign * rand_truncnorm(pred * sign, 1.0, 0.0);
 }
 
+void ProbitNoise::sample(const Array1D &vals, const Array1D &preds, Array1D &noisy_vals) const
+{
+    // sign * (sign * pred + rand_truncnorm(-sign * pred))
+    const Array1D sign = (vals < threshold).select(Array1D::Constant(vals.size(), -1.), Array1D::Ones(vals.size()));
+    rand_truncnorm(-sign * preds, noisy_vals);
+    noisy_vals = sign * noisy_vals + preds;
+}
+
 std::ostream& ProbitNoise::info(std::ostream& os, std::string indent)
 {
    os << "Probit Noise with threshold " << threshold << std::endl;
@@ -37,4 +45,9 @@ std::string ProbitNoise::getStatus()
 {
    return std::string("Probit ") + std::to_string(threshold);
 }
+
+NoiseTypes ProbitNoise::getNoiseType() const
+{
+   return NoiseTypes::probit;
+}
 } // end namespace smurff
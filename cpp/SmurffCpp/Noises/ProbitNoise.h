@@ -23,8 +23,12 @@ namespace smurff {
    public:
       double sample(const SubModel& model, const PVec<> &pos, double val) override;
 
+      // batched sample for values with known predictions
+      void sample(const Array1D &vals, const Array1D &preds, Array1D &noisy_vals) const;
+
       std::ostream& info(std::ostream& os, std::string indent) override;
       std::string getStatus() override;
+      NoiseTypes getNoiseType() const override;
    };
 
 }
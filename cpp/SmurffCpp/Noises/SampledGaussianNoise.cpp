@@ -19,4 +19,9 @@ std::string SampledGaussianNoise::getStatus()
 {
    return std::string("Sampled with fixed precision: ") + std::to_string(alpha);
 }
+
+NoiseTypes SampledGaussianNoise::getNoiseType() const
+{
+   return NoiseTypes::sampled;
+}
 } // end namespace smurff
@@ -29,4 +29,9 @@ std::string UnusedNoise::getStatus()
 {
    return std::string("Unused");
 }
+
+NoiseTypes UnusedNoise::getNoiseType() const
+{
+   return NoiseTypes::unused;
+}
 } // end namespace smurff
@@ -1,8 +1,17 @@
 #include "ILatentPrior.h"
 #include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/omp_util.h>
+
+#include <numeric>
 
 namespace smurff {
 
+// enough chunks per thread to balance the load when the cost estimate is off
+const int ILatentPrior::chunks_per_thread = 32;
+
+// rows of U per rank-k update in update_Usum
+const int ILatentPrior::usum_block_rows = 1024;
+
 ILatentPrior::ILatentPrior(TrainSession &trainSession, uint32_t mode, std::string name)
    : m_session(trainSession), m_mode(mode), m_name(name)
 {
@@ -105,25 +114,95 @@ void ILatentPrior::sample_latents()
    COUNTER("sample_latents");
    data().update_pnm(model(), m_mode);
 
-   for (int n = 0; n < U().rows(); n++)
+   if (m_chunks.empty())
+      init_chunks();
+
+   // idle threads steal the remaining chunk tasks
+   for (std::size_t i = 0; i + 1 < m_chunks.size(); i++)
 #pragma omp task
    {
       COUNTER("sample_latent");
-      sample_latent(n);
-      const auto &row = U().row(n);
-      Urow.local().noalias() += row;
-      UUrow.local().noalias() += row.transpose() * row;
+      ALLOC_COUNTER("sample_latents");
+      const int from = m_chunks[i];
+      const int to = m_chunks[i + 1];
+      sample_latent_batch(from, to);
 
-      if (m_session.inSamplingPhase())
-         model().updateAggr(m_mode, n);
+      for (int n = from; n < to; n++)
+         data().update_sumsq(model(), m_mode, n);
    }
 #pragma omp taskwait
 
+   update_Usum();
+
    if (m_session.inSamplingPhase())
       model().updateAggr(m_mode);
+}
+
+// column sum and U^T * U of the new U, one task per block of rows
+void ILatentPrior::update_Usum()
+{
+   const int nrows = num_item();
+   for (int from = 0; from < nrows; from += usum_block_rows)
+   {
+#pragma omp task
+      {
+         const auto Ub = U().middleRows(from, std::min(usum_block_rows, nrows - from));
+         Urow.local().noalias() += Ub.colwise().sum();
+         UUrow.local().selfadjointView<Eigen::Lower>().rankUpdate(Ub.transpose());
+      }
+   }
+#pragma omp taskwait
 
    Usum = Urow.combine_and_reset();
    UUsum = UUrow.combine_and_reset();
+   UUsum.triangularView<Eigen::StrictlyUpper>() = UUsum.transpose();
+}
+
+void ILatentPrior::sample_latent_batch(int from, int to)
+{
+   for (int n = from; n < to; n++)
+      sample_latent(n);
+}
+
+void ILatentPrior::init_chunks()
+{
+   // cost of a row: its observations plus the Cholesky decomposition
+   std::vector<std::uint64_t> row_cost(num_item());
+   for (int n = 0; n < num_item(); n++)
+      row_cost[n] = data().row_nnz(m_mode, n) + num_latent();
+
+   m_chunks = make_chunks(row_cost, threads::get_max_threads() * chunks_per_thread);
+}
+
+std::vector<int> ILatentPrior::make_chunks(const std::vector<std::uint64_t> &row_cost, int nchunks)
+{
+   const int nrows = row_cost.size();
+   const std::uint64_t total_cost = std::accumulate(row_cost.begin(), row_cost.end(), (std::uint64_t)0);
+   const std::uint64_t chunk_cost = std::max((std::uint64_t)1, total_cost / std::max(nchunks, 1));
+
+   std::vector<int> chunks(1, 0);
+   std::uint64_t cost = 0;
+   for (int n = 0; n < nrows; n++)
+   {
+      // heavy rows get a chunk of their own, they are split further by the data
+      if (row_cost[n] >= chunk_cost && n > chunks.back())
+      {
+         chunks.push_back(n);
+         cost = 0;
+      }
+
+      cost += row_cost[n];
+      if (cost >= chunk_cost)
+      {
+         chunks.push_back(n + 1);
+         cost = 0;
+      }
+   }
+
+   if (chunks.back() < nrows)
+      chunks.push_back(nrows);
+
+   return chunks;
 }
 
 bool ILatentPrior::save(SaveState &sf) const
@@ -75,16 +75,32 @@ public:
    virtual void sample_latents();
    virtual void sample_latent(int n) = 0;
 
+   // samples rows [from, to)
+   virtual void sample_latent_batch(int from, int to);
+
+   // splits rows into about nchunks consecutive chunks of equal cost, a row heavier
+   // than the average chunk gets a chunk of its own
+   // chunk i is rows [chunks[i], chunks[i + 1])
+   static std::vector<int> make_chunks(const std::vector<std::uint64_t> &row_cost, int nchunks);
+
    virtual void update_prior() = 0;
 
+private:
+   // rows of U are sampled one chunk per task, see make_chunks
+   std::vector<int> m_chunks;
+   static const int chunks_per_thread;
+   void init_chunks();
+
 private:
    void init_Usum();
+   void update_Usum();
    Vector Usum;
    Matrix UUsum;
 
-   // for effiency, we keep + update Urow and UUrow by every thread
+   // partial Usum and lower triangle of UUsum of every thread, see update_Usum
    thread_vector<Vector> Urow;
    thread_vector<Matrix> UUrow;
+   static const int usum_block_rows;
    
 public:
    void setMode(std::uint32_t value)
@@ -39,7 +39,7 @@ const Vector MacauOnePrior::fullMu(int n) const
    return mu() + Uhat.row(n);
 }
 
-void MacauOnePrior::addSideInfo(const std::shared_ptr<ISideInfo>& si, double bp, double tol, bool, bool ebps, bool toce)
+void MacauOnePrior::addSideInfo(const std::shared_ptr<ISideInfo>& si, double bp, double tol, bool, bool ebps, bool toce, PreconditionerTypes, bool)
 {
    Features = si;
    bp0 = bp;
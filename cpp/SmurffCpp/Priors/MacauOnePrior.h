@@ -46,7 +46,7 @@ public:
    //FIXME: tolerance_a and direct_a are not really used. 
    //should remove later after PriorFactory is properly implemented. 
    //No reason generalizing addSideInfo between priors
-   void addSideInfo(const std::shared_ptr<ISideInfo>& side, double bp, double tol, bool direct, bool enable_beta_precision_sampling, bool throw_on_cholesky_error);
+   void addSideInfo(const std::shared_ptr<ISideInfo>& side, double bp, double tol, bool direct, bool enable_beta_precision_sampling, bool throw_on_cholesky_error, PreconditionerTypes preconditioner = SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE, bool sparse_direct = false);
 
 public:
 
@@ -3,16 +3,19 @@
 #include <SmurffCpp/Utils/Distribution.h>
 #include <SmurffCpp/Utils/Error.h>
 #include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/omp_util.h>
+#include <SmurffCpp/SideInfo/linop.h>
 
 #include <ios>
 
 namespace smurff {
 
 MacauPrior::MacauPrior(TrainSession &trainSession, uint32_t mode)
-    : NormalPrior(trainSession, mode, "MacauPrior"), blockcg_iter(-1)
+    : NormalPrior(trainSession, mode, "MacauPrior"), blockcg_iter(-1), blockcg_iter_cold(-1), blockcg_blocksize(32), blockcg_excess(8)
 {
     beta_precision = SideInfoConfig::BETA_PRECISION_DEFAULT_VALUE;
     tol = SideInfoConfig::TOL_DEFAULT_VALUE;
+    preconditioner = SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE;
 
     enable_beta_precision_sampling = Config::ENABLE_BETA_PRECISION_SAMPLING_DEFAULT_VALUE;
 }
@@ -25,9 +28,24 @@ void MacauPrior::init()
 {
    NormalPrior::init();
 
+   // mu_u = mu + Uhat.row(n) differs for every row
+   m_shared_mu = false;
+
    THROWERROR_ASSERT_MSG(Features->rows() == num_item(), "Number of rows in train must be equal to number of rows in features");
 
-   if (use_FtF)
+   if (use_FtF && use_sparse_FtF)
+   {
+      THROWERROR_ASSERT_MSG(!Features->is_dense(), "The sparse direct solver needs sparse side info");
+
+      SparseMatrix FtF;
+      Features->At_mul_A(FtF);
+      FtF_sparse = FtF;
+
+      // the fill-reducing ordering and the pattern of L stay the same for every beta_precision
+      FtF_sparse_llt.analyzePattern(FtF_sparse);
+      factor_FtF();
+   }
+   else if (use_FtF)
    {
       std::uint64_t dim = num_feat();
       FtF_plus_precision.resize(dim, dim);
@@ -36,6 +54,9 @@ void MacauPrior::init()
       FtF_llt = FtF_plus_precision.llt();
    }
 
+   // the blocks of right-hand sides are solved concurrently
+   linop::tune_blockcg(num_latent(), threads::get_max_threads(), blockcg_blocksize, blockcg_excess);
+
    Uhat.resize(num_item(), num_latent());
    Uhat.setZero();
 
@@ -53,9 +74,9 @@ void MacauPrior::update_prior()
     {
         COUNTER("sample hyper mu/Lambda");
         // uses: U, Uhat
-        // writes: mu and Lambda
+        // writes: mu, Lambda and its Cholesky factor
         // complexity: num_latent x num_items
-        std::tie(mu(), Lambda) = CondNormalWishart(U() - Uhat, mu0, b0, WI + beta_precision * BtB, df + num_feat());
+        std::tie(mu(), Lambda, LambdaL) = CondNormalWishartChol(U() - Uhat, mu0, b0, WI + beta_precision * BtB, df + num_feat());
     }
 
     // uses: U, F
@@ -75,7 +96,11 @@ void MacauPrior::update_prior()
         }
 
         // writes: FtF
-        if (use_FtF)
+        if (use_FtF && use_sparse_FtF)
+        {
+            factor_FtF();
+        }
+        else if (use_FtF)
         {
             COUNTER("FtF llt");
             FtF_plus_precision.diagonal().array() += beta_precision - old_beta;
@@ -96,7 +121,14 @@ void MacauPrior::update_prior()
 void MacauPrior::sample_beta()
 {
     COUNTER("sample_beta");
-    if (use_FtF)
+    if (use_FtF && use_sparse_FtF)
+    {
+        // uses: FtF_sparse_llt, Ft_y
+        // writes: beta()
+        // complexity: num_feat x nnz(L) x num_latent
+        beta() = FtF_sparse_llt.solve(Ft_y);
+    }
+    else if (use_FtF)
     {
         // uses: FtF, Ft_y, 
         // writes: beta()
@@ -108,15 +140,27 @@ void MacauPrior::sample_beta()
         // uses: Features, beta_precision, Ft_y, 
         // writes: beta
         // complexity: num_feat x num_feat x num_iter
-        blockcg_iter = Features->solve_blockcg(beta(), beta_precision, Ft_y, tol, 32, 8, throw_on_cholesky_error);
+        // after the first solve, starts from the previous beta
+        const bool warm_start = blockcg_iter_cold >= 0;
+        blockcg_iter = Features->solve_blockcg(beta(), beta_precision, Ft_y, tol, blockcg_blocksize, blockcg_excess, throw_on_cholesky_error, preconditioner, warm_start);
+        if (!warm_start) blockcg_iter_cold = blockcg_iter;
     }
     // complexity: num_feat x num_feat x num_latent
     BtB = beta().transpose() * beta();
 }
 
-const Vector MacauPrior::fullMu(int n) const
+// numerical factorization of FtF_sparse + beta_precision * I, on the pattern of analyzePattern
+void MacauPrior::factor_FtF()
+{
+    COUNTER("FtF sparse llt");
+    FtF_sparse_llt.setShift(beta_precision);
+    FtF_sparse_llt.factorize(FtF_sparse);
+    THROWERROR_ASSERT_MSG(FtF_sparse_llt.info() == Eigen::Success, "Sparse Cholesky Decomposition of F'F failed");
+}
+
+void MacauPrior::fullMu(int n, Eigen::Ref<Vector> mu_u) const
 {
-   return mu() + Uhat.row(n);
+   mu_u = mu() + Uhat.row(n);
 }
 
 void MacauPrior::compute_Ft_y(Matrix& Ft_y)
@@ -126,22 +170,25 @@ void MacauPrior::compute_Ft_y(Matrix& Ft_y)
    // Ft_y is [ num_latent x num_feat ] matrix
 
    //HyperU: num_latent x num_item
-   HyperU = (U() + MvNormal(Lambda, num_item())).rowwise() - mu();
+   // Lambda was factored when it was sampled
+   HyperU = (U() + MvNormalChol(LambdaL, num_item())).rowwise() - mu();
    Ft_y = Features->A_mul_B(HyperU); // num_latent x num_feat
 
    //--  add beta_precision 
-   HyperU2 = MvNormal(Lambda, num_feat()); // num_latent x num_feat
+   HyperU2 = MvNormalChol(LambdaL, num_feat()); // num_latent x num_feat
    Ft_y += std::sqrt(beta_precision) * HyperU2;
 }
 
-void MacauPrior::addSideInfo(const std::shared_ptr<ISideInfo>& side, double bp, double to, bool di, bool sa, bool th)
+void MacauPrior::addSideInfo(const std::shared_ptr<ISideInfo>& side, double bp, double to, bool di, bool sa, bool th, PreconditionerTypes pc, bool sd)
 {
     Features = side;
     beta_precision = bp;
     tol = to;
     use_FtF = di;
+    use_sparse_FtF = sd;
     enable_beta_precision_sampling = sa;
     throw_on_cholesky_error = th;
+    preconditioner = pc;
 
     // Hyper-prior for beta_precision (mean 1.0, var of 1e+3):
     beta_precision_mu0 = 1.0;
@@ -154,14 +201,20 @@ std::ostream& MacauPrior::info(std::ostream &os, std::string indent)
    os << indent << " SideInfo: ";
    Features->print(os);
    os << indent << " Method: ";
-   if (use_FtF)
+   if (use_FtF && use_sparse_FtF)
+   {
+      os << "Sparse Cholesky Decomposition (F'F has " << FtF_sparse.nonZeros() << " non-zeros)" << std::endl;
+   }
+   else if (use_FtF)
    {
       os << "Cholesky Decomposition";
       double needs_gb = (double)num_feat() / 1024. * (double)num_feat() / 1024. / 1024.;
       if (needs_gb > 1.0) os << " (needing " << needs_gb << " GB of memory)";
       os << std::endl;
    } else {
-      os << "CG Solver with tolerance: " << std::scientific << tol << std::fixed << std::endl;
+      os << "CG Solver with tolerance: " << std::scientific << tol << std::fixed
+         << ", preconditioner: " << preconditionerTypeToString(preconditioner)
+         << ", blocks of " << blockcg_blocksize << " (+" << blockcg_excess << ")" << std::endl;
    }
    os << indent << " BetaPrecision: ";
    if (enable_beta_precision_sampling)
@@ -182,8 +235,20 @@ std::ostream &MacauPrior::status(std::ostream &os, std::string indent) const
    indent += "  ";
    os << indent << "mu           = " <<  mu() << std::endl;
    os << indent << "Uhat mean    = " <<  Uhat.colwise().mean() << std::endl;
-   os << indent << "blockcg iter = " << blockcg_iter << std::endl;
-   os << indent << "FtF_plus_prec= " << FtF_plus_precision.norm() << std::endl;
+   os << indent << "blockcg iter = " << blockcg_iter;
+   if (!use_FtF)
+   {
+      os << " (preconditioner: " << preconditionerTypeToString(preconditioner);
+      // the first solve is of another system, the counts are not comparable
+      if (blockcg_iter_cold >= 0)
+         os << ", warm start, first solve from zero: " << blockcg_iter_cold;
+      os << ")";
+   }
+   os << std::endl;
+   if (use_FtF && use_sparse_FtF)
+      os << indent << "FtF L nnz    = " << FtF_sparse_llt.matrixL().nestedExpression().nonZeros() << std::endl;
+   else if (use_FtF)
+      os << indent << "FtF_plus_prec= " << FtF_plus_precision.norm() << std::endl;
    os << indent << "HyperU       = " << HyperU.norm() << std::endl;
    os << indent << "HyperU2      = " << HyperU2.norm() << std::endl;
    os << indent << "Beta         = " << beta().norm() << std::endl;
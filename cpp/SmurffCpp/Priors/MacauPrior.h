@@ -25,12 +25,17 @@ public:
    Matrix Uhat;                // num_latent x num_items
    Matrix FtF_plus_precision;  // num_feat   x num feat
    Eigen::LLT<Matrix> FtF_llt; // num_feat   x num feat
+   Eigen::SparseMatrix<float_type> FtF_sparse;           // num_feat x num_feat, without precision
+   Eigen::SimplicialLLT<Eigen::SparseMatrix<float_type> > FtF_sparse_llt; // of FtF_sparse + beta_precision * I
    Matrix HyperU;              // num_latent x num_items
    Matrix HyperU2;             // num_latent x num_feat
    Matrix Ft_y;                // num_latent x num_feat -- RHS
    Matrix BtB;                 // num_latent x num_latent
 
    int blockcg_iter;
+   int blockcg_iter_cold; // of the first solve, which starts from zero
+   int blockcg_blocksize; // right-hand sides per block of the CG solver
+   int blockcg_excess;    // extra ones the last block can take
    
    double beta_precision_mu0; // Hyper-prior for beta_precision
    double beta_precision_nu0; // Hyper-prior for beta_precision
@@ -39,8 +44,10 @@ public:
    double beta_precision;
    double tol = 1e-6;
    bool use_FtF;
+   bool use_sparse_FtF = false; // with use_FtF, factor F'F as a sparse matrix
    bool enable_beta_precision_sampling;
    bool throw_on_cholesky_error;
+   PreconditionerTypes preconditioner; // of the CG solver
 
 public:
    MacauPrior(TrainSession &trainSession, uint32_t mode);
@@ -51,15 +58,16 @@ public:
 
    void update_prior() override;
 
-   const Vector fullMu(int n) const override;
+   void fullMu(int n, Eigen::Ref<Vector> mu_u) const override;
 
    int num_feat() const { return Features->cols(); }
 
    void compute_Ft_y(Matrix& Ft_y);
+   void factor_FtF();
    virtual void sample_beta();
 
 public:
-   void addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, double beta_precision_a, double tolerance_a, bool direct_a, bool enable_beta_precision_sampling_a, bool throw_on_cholesky_error_a);
+   void addSideInfo(const std::shared_ptr<ISideInfo>& side_info_a, double beta_precision_a, double tolerance_a, bool direct_a, bool enable_beta_precision_sampling_a, bool throw_on_cholesky_error_a, PreconditionerTypes preconditioner_a = SideInfoConfig::PRECONDITIONER_DEFAULT_VALUE, bool sparse_direct_a = false);
 
 public:
    std::ostream& info(std::ostream &os, std::string indent) override;
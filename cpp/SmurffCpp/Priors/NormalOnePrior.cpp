@@ -44,8 +44,10 @@ void NormalOnePrior::sample_latent(int d)
 {
    const int K = num_latent();
 
-   Matrix XX = Matrix::Zero(K, K);
-   Vector yX = Vector::Zero(K);
+   Matrix &XX = MMs.local();
+   Vector &yX = rrs.local();
+   XX.setZero();
+   yX.setZero();
 
    data().getMuLambda(model(), m_mode, d, yX, XX);
 
@@ -56,7 +58,7 @@ void NormalOnePrior::sample_latent(int d)
    for(int k=0;k<K;++k) sample_latent(d, k, XX, yX);
 }
  
-std::pair<float_type,float_type> NormalOnePrior::sample_latent(int d, int k, const Matrix& XX, const Vector& yX)
+std::pair<float_type,float_type> NormalOnePrior::sample_latent(int d, int k, const Eigen::Ref<const Matrix>& XX, const Vector& yX)
 {
     auto Urow = U().row(d);
     float_type lambda = XX(k,k);
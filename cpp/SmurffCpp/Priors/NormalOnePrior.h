@@ -37,7 +37,7 @@ public:
    virtual const Vector fullMu(int n) const;
 
    void sample_latent(int n) override;
-   virtual std::pair<float_type,float_type> sample_latent(int d, int k, const Matrix& XX, const Vector& yX);
+   virtual std::pair<float_type,float_type> sample_latent(int d, int k, const Eigen::Ref<const Matrix>& XX, const Vector& yX);
 
    void update_prior() override;
 
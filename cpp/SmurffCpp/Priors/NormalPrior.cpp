@@ -14,6 +14,9 @@ namespace smurff {
 
 //  base class NormalPrior
 
+const int NormalPrior::batch_rows;
+const int NormalPrior::batch_max_latent;
+
 NormalPrior::NormalPrior(TrainSession &trainSession, uint32_t mode, std::string name)
    : ILatentPrior(trainSession, mode, name)
 {}
@@ -30,6 +33,7 @@ void NormalPrior::init()
    Lambda.resize(K, K);
    Lambda.setIdentity();
    Lambda *= 10;
+   LambdaL = Matrix::Identity(K, K) * std::sqrt(10.);
 
    // parameters of Inv-Whishart distribution
    WI.resize(K, K);
@@ -44,38 +48,96 @@ void NormalPrior::init()
    {
       m_name += " with posterior propagation";
    }
+
+   m_shared_Lambda = !config.hasPropagatedPosterior(getMode());
+   m_shared_mu = m_shared_Lambda;
+   muLambda = mu() * Lambda;
+
+   // common numbers of latents get a fixed-size kernel,
+   // up to batch_max_latent latents sample_latent_batch is used instead
+   switch (K)
+   {
+      case 32: m_sample_latent = &NormalPrior::sample_latent_k<32>; break;
+      case 64: m_sample_latent = &NormalPrior::sample_latent_k<64>; break;
+      default: m_sample_latent = &NormalPrior::sample_latent_k<Eigen::Dynamic>; break;
+   }
 }
 
-const Vector NormalPrior::fullMu(int n) const
+void NormalPrior::fullMu(int n, Eigen::Ref<Vector> mu_u) const
 {
-   if (getConfig().hasPropagatedPosterior(getMode()))
+   if (!m_shared_Lambda)
    {
-      return getConfig().getMuPropagatedPosterior(getMode()).getDenseMatrixData().row(n);
+      mu_u = getConfig().getMuPropagatedPosterior(getMode()).getDenseMatrixData().row(n);
+      return;
    }
    //else
-   return mu();
+   mu_u = mu();
 }
 
-const Matrix NormalPrior::getLambda(int n) const
+Eigen::Map<const Matrix> NormalPrior::getLambda(int n) const
 {
-   if (getConfig().hasPropagatedPosterior(getMode()))
+   if (!m_shared_Lambda)
    {
       const auto &Lambda_pp = getConfig().getLambdaPropagatedPosterior(getMode()).getDenseMatrixData();
       return Eigen::Map<const Matrix>(Lambda_pp.row(n).data(), num_latent(), num_latent());
    }
    //else
-   return Lambda;
+   return Eigen::Map<const Matrix>(Lambda.data(), num_latent(), num_latent());
 }
 void NormalPrior::update_prior()
 {
-   std::tie(mu(), Lambda) = CondNormalWishart(num_item(), getUUsum(), getUsum(), mu0, b0, WI, df);
+   std::tie(mu(), Lambda, LambdaL) = CondNormalWishartChol(num_item(), getUUsum(), getUsum(), mu0, b0, WI, df);
+   muLambda = mu() * Lambda;
+}
+
+void NormalPrior::addMuLambda(int n, Eigen::Ref<Vector> rr) const
+{
+   if (m_shared_mu)
+   {
+      rr += muLambda;
+      return;
+   }
+
+   ScratchArena &arena = data().arena();
+   ScratchArena::Frame frame(arena);
+   auto mu_u = arena.vector(num_latent());
+   fullMu(n, mu_u);
+   rr.noalias() += mu_u * getLambda(n);
+}
+
+bool NormalPrior::samplePriorOnly(int n) const
+{
+   return m_shared_Lambda && data().row_nobs(m_mode, n) == 0;
+}
+
+// MM is zero and rr is mu_u * Lambda: the posterior is the prior, and LambdaL its factor
+void NormalPrior::sample_prior(int n)
+{
+   auto u = U().row(n);
+   u = Vector::NullaryExpr(num_latent(), RandNormalGenerator());
+   LambdaL.triangularView<Eigen::Lower>().transpose().solveInPlace(u.transpose()); // x = L^-T * z
+
+   ScratchArena &arena = data().arena();
+   ScratchArena::Frame frame(arena);
+   auto mu_u = arena.vector(num_latent());
+   fullMu(n, mu_u);
+   u += mu_u;
 }
 
 //n is an index of column in U matrix
 void  NormalPrior::sample_latent(int n)
 {
-   const auto &mu_u = fullMu(n);
-   const auto &Lambda_u = getLambda(n);
+   (this->*m_sample_latent)(n);
+}
+
+template<int K>
+void NormalPrior::sample_latent_k(int n)
+{
+   if (samplePriorOnly(n))
+   {
+      sample_prior(n);
+      return;
+   }
 
    Vector &rr = rrs.local();
    Matrix &MM = MMs.local();
@@ -87,26 +149,215 @@ void  NormalPrior::sample_latent(int n)
    data().getMuLambda(model(), m_mode, n, rr, MM);
 
    // add hyperparams
-   rr.noalias() += mu_u * Lambda_u;
-   MM.noalias() += Lambda_u;
+   addMuLambda(n, rr);
+
+   // the fixed-size versions live on the stack
+   if (K == Eigen::Dynamic)
+      sample_posterior_inplace(rr, MM, getLambda(n), U().row(n));
+   else
+      sample_posterior<K>(rr, MM, getLambda(n), U().row(n));
+}
+
+template<int K>
+void NormalPrior::sample_posterior(const Vector &rr, const Matrix &MM,
+                                   const Eigen::Map<const Matrix> &Lambda_u, Eigen::Ref<Vector> u)
+{
+   typedef Eigen::Matrix<float_type, 1, K, Eigen::RowMajor> VectorK;
+   typedef Eigen::Matrix<float_type, K, K, Eigen::RowMajor> MatrixK;
+
+   const int num_latent = rr.size();
+
+   VectorK x = rr;
 
    //Solve system of linear equations for x: MM * x = rr - not exactly correct  because we have random part
    //Sample from multivariate normal distribution with mean rr and precision matrix MM
 
-   Eigen::LLT<Matrix> chol;
+   Eigen::LLT<MatrixK> chol(MM + Lambda_u); // compute the Cholesky decomposition X = L * U
+   if(chol.info() != Eigen::Success)
    {
-      chol = MM.llt(); // compute the Cholesky decomposition X = L * U
-      if(chol.info() != Eigen::Success)
-      {
-         THROWERROR("Cholesky Decomposition failed!");
-      }
+      THROWERROR("Cholesky Decomposition failed!");
+   }
+
+   chol.matrixL().solveInPlace(x.transpose()); // solve for y: y = L^-1 * b
+   x.noalias() += VectorK::NullaryExpr(num_latent, RandNormalGenerator());
+   chol.matrixU().solveInPlace(x.transpose()); // solve for x: x = U^-1 * y
+   
+   u = x;
+}
+
+void NormalPrior::sample_posterior_inplace(Vector &rr, Matrix &MM,
+                                           const Eigen::Map<const Matrix> &Lambda_u, Eigen::Ref<Vector> u)
+{
+   MM += Lambda_u;
+
+   Eigen::LLT<Eigen::Ref<Matrix> > chol(MM); // in place, MM holds L afterwards
+   if(chol.info() != Eigen::Success)
+   {
+      THROWERROR("Cholesky Decomposition failed!");
    }
 
    chol.matrixL().solveInPlace(rr.transpose()); // solve for y: y = L^-1 * b
-   rr.noalias() += Vector::NullaryExpr(num_latent(), RandNormalGenerator());
+   rr.noalias() += Vector::NullaryExpr(rr.size(), RandNormalGenerator());
    chol.matrixU().solveInPlace(rr.transpose()); // solve for x: x = U^-1 * y
-   
-   U().row(n).noalias() = rr; // rr is equal to x
+
+   u = rr;
+}
+
+template void NormalPrior::sample_posterior<32>(const Vector &, const Matrix &, const Eigen::Map<const Matrix> &, Eigen::Ref<Vector>);
+template void NormalPrior::sample_posterior<64>(const Vector &, const Matrix &, const Eigen::Map<const Matrix> &, Eigen::Ref<Vector>);
+
+void NormalPrior::sample_latent_batch(int from, int to)
+{
+   const int K = num_latent();
+   if (K > batch_max_latent)
+   {
+      ILatentPrior::sample_latent_batch(from, to);
+      return;
+   }
+
+   alignas(64) float_type A[batch_max_latent * batch_max_latent * batch_rows];
+   alignas(64) float_type x[batch_max_latent * batch_rows];
+
+   Vector &rr = rrs.local();
+   Matrix &MM = MMs.local();
+
+   for (int n = from; n < to; )
+   {
+      // rows without observations in between are sampled on their own, in order
+      if (samplePriorOnly(n))
+      {
+         sample_prior(n++);
+         continue;
+      }
+
+      // build the systems of the rows, interleaved
+      // probit noise draws in getMuLambda, so then the samples differ from those of sample_latent
+      const int from_b = n;
+      int nrows = 0;
+      for (; nrows < batch_rows && n < to && !samplePriorOnly(n); nrows++, n++)
+      {
+         const int l = nrows;
+         rr.setZero();
+         MM.setZero();
+
+         // add pnm
+         data().getMuLambda(model(), m_mode, n, rr, MM);
+
+         // add hyperparams
+         addMuLambda(n, rr);
+         MM.noalias() += getLambda(n);
+
+         for (int i = 0; i < K; i++)
+         {
+            for (int j = 0; j <= i; j++)
+               A[(i * K + j) * batch_rows + l] = MM(i, j);
+            x[i * batch_rows + l] = rr(i);
+         }
+      }
+
+      sample_posterior_batch(K, nrows, A, x);
+
+      for (int l = 0; l < nrows; l++)
+         for (int i = 0; i < K; i++)
+            U()(from_b + l, i) = x[i * batch_rows + l];
+   }
+}
+
+void NormalPrior::sample_posterior_batch(int K, int nrows, float_type *A, float_type *x)
+{
+   const int B = batch_rows;
+
+   // unused lanes get the identity
+   for (int l = nrows; l < B; l++)
+   {
+      for (int i = 0; i < K; i++)
+      {
+         for (int j = 0; j <= i; j++)
+            A[(i * K + j) * B + l] = (i == j);
+         x[i * B + l] = 0.0;
+      }
+   }
+
+   auto a = [A, K, B](int i, int j) { return A + (i * K + j) * B; };
+   auto b = [x, B](int i) { return x + i * B; };
+
+   // Cholesky decomposition MM = L * L^T, in place in the lower triangle
+   for (int j = 0; j < K; j++)
+   {
+      float_type *ajj = a(j, j);
+      for (int k = 0; k < j; k++)
+      {
+         const float_type *ajk = a(j, k);
+         for (int l = 0; l < B; l++)
+            ajj[l] -= ajk[l] * ajk[l];
+      }
+
+      for (int l = 0; l < B; l++)
+      {
+         if (!(ajj[l] > 0.0))
+         {
+            THROWERROR("Cholesky Decomposition failed!");
+         }
+         ajj[l] = std::sqrt(ajj[l]);
+      }
+
+      for (int i = j + 1; i < K; i++)
+      {
+         float_type *aij = a(i, j);
+         for (int k = 0; k < j; k++)
+         {
+            const float_type *aik = a(i, k);
+            const float_type *ajk = a(j, k);
+            for (int l = 0; l < B; l++)
+               aij[l] -= aik[l] * ajk[l];
+         }
+
+         for (int l = 0; l < B; l++)
+            aij[l] /= ajj[l];
+      }
+   }
+
+   // solve for y: y = L^-1 * b
+   for (int i = 0; i < K; i++)
+   {
+      float_type *xi = b(i);
+      for (int k = 0; k < i; k++)
+      {
+         const float_type *aik = a(i, k);
+         const float_type *xk = b(k);
+         for (int l = 0; l < B; l++)
+            xi[l] -= aik[l] * xk[l];
+      }
+
+      const float_type *aii = a(i, i);
+      for (int l = 0; l < B; l++)
+         xi[l] /= aii[l];
+   }
+
+   // add the random part, drawn row by row like in sample_posterior
+   for (int l = 0; l < nrows; l++)
+   {
+      RandNormalGenerator rng;
+      for (int i = 0; i < K; i++)
+         b(i)[l] += rng(0);
+   }
+
+   // solve for x: x = L^-T * y
+   for (int i = K - 1; i >= 0; i--)
+   {
+      float_type *xi = b(i);
+      for (int k = i + 1; k < K; k++)
+      {
+         const float_type *aki = a(k, i);
+         const float_type *xk = b(k);
+         for (int l = 0; l < B; l++)
+            xi[l] -= aki[l] * xk[l];
+      }
+
+      const float_type *aii = a(i, i);
+      for (int l = 0; l < B; l++)
+         xi[l] /= aii[l];
+   }
 }
 
 std::ostream &NormalPrior::status(std::ostream &os, std::string indent) const
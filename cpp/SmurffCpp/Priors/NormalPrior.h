@@ -20,6 +20,8 @@ public:
   Vector &mu() { return model().getMu(getMode()); } 
   const Vector &mu() const { return model().getMu(getMode()); } 
   Matrix Lambda;
+  Matrix LambdaL; // lower Cholesky factor of Lambda, sampled with it
+  Vector muLambda; // mu * Lambda, the same for every row unless mu or Lambda depend on the row
 
   Matrix WI;
   Vector mu0;
@@ -36,12 +38,53 @@ public:
   //mu in NormalPrior does not depend on column index
   //however successors of this class can override this method
   //for example in MacauPrior mu depends on Uhat.row(n)
-  virtual const Vector fullMu(int n) const;
-  const Matrix getLambda(int n) const;
+  virtual void fullMu(int n, Eigen::Ref<Vector> mu_u) const;
+  Eigen::Map<const Matrix> getLambda(int n) const;
   
   void sample_latent(int n) override;
 
+  //adds mu_u * Lambda_u of row n to rr
+  void addMuLambda(int n, Eigen::Ref<Vector> rr) const;
+
+  //samples u ~ N((MM + Lambda_u)^-1 * rr, (MM + Lambda_u)^-1), with MM from the data
+  //and rr from the data plus mu_u * Lambda_u
+  //K is the number of latents, the fixed-size versions keep everything on the stack
+  template<int K>
+  static void sample_posterior(const Vector &rr, const Matrix &MM,
+                               const Eigen::Map<const Matrix> &Lambda_u, Eigen::Ref<Vector> u);
+
+  //same for any number of latents without allocating, rr and MM are overwritten
+  static void sample_posterior_inplace(Vector &rr, Matrix &MM,
+                                       const Eigen::Map<const Matrix> &Lambda_u, Eigen::Ref<Vector> u);
+
+  //rows without observations are sampled from the prior, u ~ N(mu_u, Lambda^-1), with LambdaL
+  bool samplePriorOnly(int n) const;
+  void sample_prior(int n);
+
+  //rows are sampled batch_rows at a time when there are at most batch_max_latent latents
+  static const int batch_rows = 8;
+  static const int batch_max_latent = 16;
+
+  void sample_latent_batch(int from, int to) override;
+
+  //samples nrows rows at once, one SIMD lane per row
+  //coefficient (i, j) of the lower triangle of MM + Lambda_u of row l is in A[(i * K + j) * batch_rows + l],
+  //coefficient i of rr + mu_u * Lambda_u of row l is in x[i * batch_rows + l], the sample is returned in x
+  static void sample_posterior_batch(int K, int nrows, float_type *A, float_type *x);
+
   void update_prior() override;
   std::ostream &status(std::ostream &os, std::string indent) const override;
+
+protected:
+  //without propagated posteriors all rows share Lambda, and mu too when it does not depend on the row
+  bool m_shared_Lambda = true;
+  bool m_shared_mu = true;
+
+private:
+  //sample_latent for K latents, selected in init
+  template<int K>
+  void sample_latent_k(int n);
+
+  void (NormalPrior::*m_sample_latent)(int) = nullptr;
 };
 }
@@ -46,13 +46,13 @@ std::shared_ptr<ILatentPrior> PriorFactory::create_macau_prior(TrainSession &tra
    {
    case NoiseTypes::fixed:
       {
-         prior->addSideInfo(side_info, noise_config.getPrecision(), config_item.getTol(), config_item.getDirect(), false, config_item.getThrowOnCholeskyError());
+         prior->addSideInfo(side_info, noise_config.getPrecision(), config_item.getTol(), config_item.getDirect(), false, config_item.getThrowOnCholeskyError(), config_item.getPreconditionerType(), config_item.getSparseDirect());
       }
       break;
    case NoiseTypes::adaptive: // deprecated!
    case NoiseTypes::sampled:
       {
-         prior->addSideInfo(side_info, noise_config.getPrecision(), config_item.getTol(), config_item.getDirect(), true, config_item.getThrowOnCholeskyError());
+         prior->addSideInfo(side_info, noise_config.getPrecision(), config_item.getTol(), config_item.getDirect(), true, config_item.getThrowOnCholeskyError(), config_item.getPreconditionerType(), config_item.getSparseDirect());
       }
       break;
    default:
@@ -90,13 +90,16 @@ void SpikeAndSlabPrior::restore(const SaveState &sf)
   update_prior();
 }
 
-std::pair<float_type, float_type> SpikeAndSlabPrior::sample_latent(int d, int k, const Matrix& XX, const Vector& yX)
+std::pair<float_type, float_type> SpikeAndSlabPrior::sample_latent(int d, int k, const Eigen::Ref<const Matrix>& XX, const Vector& yX)
 {
     const int v = data().view(m_mode, d);
     float_type mu, lambda;
 
-    Matrix aXX = alpha.matrix().row(v).asDiagonal();
-    aXX += XX;
+    ScratchArena &arena = data().arena();
+    ScratchArena::Frame frame(arena);
+    auto aXX = arena.matrix(XX.rows(), XX.cols());
+    aXX = XX;
+    aXX.diagonal() += alpha.matrix().row(v).transpose();
     std::tie(mu, lambda) = NormalOnePrior::sample_latent(d, k, aXX, yX);
 
     auto Urow = U().row(d);
@@ -36,7 +36,7 @@ public:
 
    void restore(const SaveState &sf) override;
 
-   std::pair<float_type,float_type> sample_latent(int d, int k, const Matrix& XX, const Vector& yX) override;
+   std::pair<float_type,float_type> sample_latent(int d, int k, const Eigen::Ref<const Matrix>& XX, const Vector& yX) override;
 
    void update_prior() override;
 
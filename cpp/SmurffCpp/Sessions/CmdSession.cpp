@@ -35,6 +35,7 @@ static const std::string NUM_THREADS_NAME = "num-threads";
 static const std::string SAVE_NAME = "save-name";
 static const std::string SAVE_FREQ_NAME = "save-freq";
 static const std::string CHECKPOINT_FREQ_NAME = "checkpoint-freq";
+static const std::string AGGREGATE_NAME = "aggregate";
 static const std::string THRESHOLD_NAME = "threshold";
 static const std::string VERBOSE_NAME = "verbose";
 static const std::string VERSION_NAME = "version";
@@ -74,7 +75,8 @@ po::options_description get_desc()
 	(RESTORE_NAME.c_str(), po::value<std::string>(), "restore trainSession from a saved .h5 file")
 	(SAVE_NAME.c_str(), po::value<std::string>()->default_value(Config::SAVE_NAME_DEFAULT_VALUE), "save model and/or predictions to this .h5 file")
 	(SAVE_FREQ_NAME.c_str(), po::value<int>()->default_value(Config::SAVE_FREQ_DEFAULT_VALUE), "save every n iterations (0 == never, -1 == final model)")
-	(CHECKPOINT_FREQ_NAME.c_str(), po::value<int>()->default_value(Config::CHECKPOINT_FREQ_DEFAULT_VALUE), "save state every n seconds, only one checkpointing state is kept");
+	(CHECKPOINT_FREQ_NAME.c_str(), po::value<int>()->default_value(Config::CHECKPOINT_FREQ_DEFAULT_VALUE), "save state every n seconds, only one checkpointing state is kept")
+	(AGGREGATE_NAME.c_str(), po::value<std::string>()->default_value(aggregateTypeToString(Config::AGGREGATE_DEFAULT_VALUE)), "storage for the posterior mean and precision of the latents: <packed|diagonal|spill|none>");
 
     po::options_description desc("SMURFF: Scalable Matrix Factorization Framework\n\thttp://github.com/ExaScience/smurff");
     desc.add(general_desc);
@@ -163,6 +165,7 @@ fill_config(const po::variables_map &vm)
     filler.set<std::string, &Config::setSaveName>(SAVE_NAME);
     filler.set<int,         &Config::setSaveFreq>(SAVE_FREQ_NAME);
     filler.set<int,         &Config::setCheckpointFreq>(CHECKPOINT_FREQ_NAME);
+    filler.set<std::string, &Config::setAggregateType>(AGGREGATE_NAME);
     filler.set<double,      &Config::setThreshold>(THRESHOLD_NAME);
     filler.set<int,         &Config::setVerbose>(VERBOSE_NAME);
     filler.set<int,         &Config::setRandomSeed>(SEED_NAME);
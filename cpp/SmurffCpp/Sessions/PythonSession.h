@@ -24,6 +24,7 @@ public:
    void setSaveFreq(int value) { m_config.setSaveFreq(value); } 
    void setSavePred(bool value) { m_config.setSavePred(value); } 
    void setCheckpointFreq(int value) { m_config.setCheckpointFreq(value); } 
+   void setAggregateType(std::string value) { m_config.setAggregateType(value); }
    void setRandomSeed(int value) { m_config.setRandomSeed(value); } 
    void setVerbose(int value) { m_config.setVerbose(value); } 
    void setBurnin(int value) { m_config.setBurnin(value); } 
@@ -39,27 +40,32 @@ public:
    }
 
    template <typename SparseType>
-   void setTrain(const SparseType &data, const NoiseConfig &nc, bool is_scarce)
+   void setTrain(const SparseType &data, const NoiseConfig &nc, bool is_scarce, bool is_binary)
    {
        auto &train = m_config.getTrain();
        train.setData(data, is_scarce);
+       train.setBinary(is_binary);
        train.setNoiseConfig(nc);
    }
 
-   void addSideInfoDense(int mode, const Matrix &data, const NoiseConfig &nc, bool direct) 
+   void addSideInfoDense(int mode, const Matrix &data, const NoiseConfig &nc, bool direct, std::string preconditioner, bool sparse_direct) 
    {
       auto &si = m_config.addSideInfo(mode);
       si.setData(data);
       si.setNoiseConfig(nc);
       si.setDirect(direct);
+      si.setPreconditionerType(preconditioner);
+      si.setSparseDirect(sparse_direct);
    }
 
-   void addSideInfoSparse(int mode, const SparseMatrix &data, const NoiseConfig &nc, bool direct) 
+   void addSideInfoSparse(int mode, const SparseMatrix &data, const NoiseConfig &nc, bool direct, std::string preconditioner, bool sparse_direct) 
    {
       auto &si = m_config.addSideInfo(mode);
       si.setData(data, false);
       si.setNoiseConfig(nc);
       si.setDirect(direct);
+      si.setPreconditionerType(preconditioner);
+      si.setSparseDirect(sparse_direct);
    }
 
    template <typename DenseType>
@@ -72,11 +78,12 @@ public:
    }
  
    template <typename SparseType>
-   void addDataSparse(std::vector<int> pos, const SparseType &data, const NoiseConfig &nc, bool is_scarce)
+   void addDataSparse(std::vector<int> pos, const SparseType &data, const NoiseConfig &nc, bool is_scarce, bool is_binary)
    {
       auto &data_config = m_config.addData();
       data_config.setPos(pos);
       data_config.setData(data, is_scarce);
+      data_config.setBinary(is_binary);
       data_config.setNoiseConfig(nc);
    }
 
@@ -50,6 +50,10 @@ void TrainSession::init()
 
     // init data
     data_ptr = Data::create(getConfig().getData());
+
+    // data_ptr has its own copy now
+    for (auto &dc : m_config.getData())
+        dc.releaseData();
    
     // initialize priors
     std::shared_ptr<IPriorFactory> priorFactory = this->create_prior_factory();
@@ -75,12 +79,19 @@ void TrainSession::init()
     data().init();
 
     //initialize model (samples)
-    model().init(getConfig().getNumLatent(), data().dim(), getConfig().getModelInitType(), getConfig().getSaveModel());
+    //posterior aggregates only end up in the output file
+    const auto &save_name = getConfig().getSaveName();
+    auto aggregate = save_name.empty() ? AggregateTypes::none : getConfig().getAggregateType();
+    model().init(getConfig().getNumLatent(), data().dim(), getConfig().getModelInitType(), getConfig().getSaveModel(),
+                 aggregate, save_name + ".aggr");
 
     //initialize priors
     for (auto &p : m_priors)
         p->init();
 
+    //initialize scratch space for sampling
+    initArenas();
+
     // all basic init done
     m_is_init = true;
 
@@ -120,6 +131,10 @@ bool TrainSession::step()
         #pragma omp master 
         for (auto p : m_priors)
         {
+            // nothing is using the arenas between modes
+            for (auto &arena : *m_arenas)
+                arena.reset();
+
             p->sample_latents();
             #pragma omp task
             p->update_prior();
@@ -142,6 +157,34 @@ bool TrainSession::step()
     return isStep;
 }
 
+// sizes the arenas for the temporaries of getMuLambda and sample_latent, they
+// grow at the next reset when this estimate turns out too small
+void TrainSession::initArenas()
+{
+    const std::size_t K = model().nlatent();
+    const std::size_t nthreads = threads::get_max_threads();
+
+    std::uint64_t max_degree = 0;
+    for (std::uint64_t m = 0; m < data().nmode(); ++m)
+        for (int d = 0; d < data().dim(m); ++d)
+            max_degree = std::max(max_degree, data().row_nnz(m, d));
+
+    const std::size_t panel_rows = std::min<std::uint64_t>(max_degree, 256);
+
+    std::size_t bytes = 0;
+    bytes += 2 * ScratchArena::footprint<float_type>(K + K * K);          // rr and MM of a row, mu_u
+    bytes += ScratchArena::footprint<float_type>(nthreads * (K + K * K)); // per-thread partial sums of a heavy row
+    bytes += ScratchArena::footprint<float_type>(panel_rows * (K + 2));   // gathered panel with its values
+    bytes += ScratchArena::footprint<float_type>(max_degree);             // noisy values of a dense row
+    bytes += ScratchArena::footprint<std::ptrdiff_t>(2 * data().nmode()); // V matrices of a tensor
+
+    // each thread allocates and first touches its own arena
+    m_arenas = std::make_shared<thread_vector<ScratchArena> >();
+    m_arenas->init(ScratchArena(bytes));
+
+    data().setArenas(m_arenas);
+}
+
 std::ostream &TrainSession::info(std::ostream &os, std::string indent) const
 {
     os << indent << name << " {\n";
@@ -7,6 +7,8 @@
 #include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Priors/IPriorFactory.h>
 #include <SmurffCpp/Utils/StateFile.h>
+#include <SmurffCpp/Utils/ScratchArena.h>
+#include <SmurffCpp/Utils/ThreadVector.hpp>
 #include <SmurffCpp/StatusItem.h>
 #include <SmurffCpp/Sessions/ISession.h>
 #include <SmurffCpp/Model.h>
@@ -32,6 +34,9 @@ protected:
    //train data
    std::shared_ptr<Data> data_ptr;
 
+   //per-thread scratch space of the sampling hot path, shared with the data
+   std::shared_ptr<thread_vector<ScratchArena> > m_arenas;
+
 private:
    std::shared_ptr<StateFile> m_stateFile;
 
@@ -76,6 +81,7 @@ public:
 
 private:
    void initRng();
+   void initArenas();
 
 public:
    virtual std::shared_ptr<IPriorFactory> create_prior_factory() const;
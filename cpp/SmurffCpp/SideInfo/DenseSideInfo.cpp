@@ -41,17 +41,29 @@ void DenseSideInfo::At_mul_A(Matrix& out)
    out = m_side_info.transpose() * m_side_info;
 }
 
+void DenseSideInfo::At_mul_A(SparseMatrix& out)
+{
+   THROWERROR_NOTIMPL();
+}
+
 Matrix DenseSideInfo::A_mul_B(Matrix& A)
 {
    return m_side_info.transpose() * A;
 }
 
-int DenseSideInfo::solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+void DenseSideInfo::AtA_mul_B(Matrix& out, double reg, const Matrix& B, Matrix& tmp) const
+{
+   tmp.noalias() = m_side_info * B;
+   out.noalias() = m_side_info.transpose() * tmp;
+   out += reg * B;
+}
+
+int DenseSideInfo::solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error, PreconditionerTypes preconditioner, bool warm_start)
 {
    THROWERROR_NOTIMPL();
 }
 
-Vector DenseSideInfo::col_square_sum()
+Vector DenseSideInfo::col_square_sum() const
 {
     return m_side_info.array().square().colwise().sum();
 }
@@ -36,11 +36,15 @@ namespace smurff {
 
       void At_mul_A(Matrix& out) override;
 
+      void At_mul_A(SparseMatrix& out) override;
+
       Matrix A_mul_B(Matrix& A) override;
 
-      int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
+      void AtA_mul_B(Matrix& out, double reg, const Matrix& B, Matrix& tmp) const override;
+
+      int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false, PreconditionerTypes preconditioner = PreconditionerTypes::none, bool warm_start = false) override;
 
-      Vector col_square_sum() override;
+      Vector col_square_sum() const override;
 
       void At_mul_Bt(Vector& Y, const int row, Matrix& B) override;
 
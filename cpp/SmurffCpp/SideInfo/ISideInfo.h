@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include <SmurffCpp/Types.h>
+#include <SmurffCpp/Configs/SideInfoConfig.h>
 
 namespace smurff {
 
@@ -26,11 +27,17 @@ namespace smurff {
 
       virtual void At_mul_A(Matrix& out) = 0;
 
+      // F' * F as a sparse matrix, only for sparse side info
+      virtual void At_mul_A(SparseMatrix& out) = 0;
+
       virtual Matrix A_mul_B(Matrix& A) = 0;
 
-      virtual int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) = 0;
+      // out = F' * (F * B) + reg * B, tmp holds F * B
+      virtual void AtA_mul_B(Matrix& out, double reg, const Matrix& B, Matrix& tmp) const = 0;
+
+      virtual int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false, PreconditionerTypes preconditioner = PreconditionerTypes::none, bool warm_start = false) = 0;
 
-      virtual Vector col_square_sum() = 0;
+      virtual Vector col_square_sum() const = 0;
 
       virtual void At_mul_Bt(Vector& Y, const int row, Matrix& B) = 0;
 
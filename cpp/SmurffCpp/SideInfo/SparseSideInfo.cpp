@@ -7,9 +7,9 @@
 
 namespace smurff {
 
-SparseSideInfo::SparseSideInfo(const DataConfig &mc) {
-    F = mc.getSparseMatrixData();
-    Ft = F.transpose();
+SparseSideInfo::SparseSideInfo(const DataConfig &mc)
+    : F(mc.getSparseMatrixData())
+{
 }
 
 SparseSideInfo::~SparseSideInfo() {}
@@ -41,28 +41,56 @@ bool SparseSideInfo::is_dense() const
 void SparseSideInfo::compute_uhat(Matrix& uhat, Matrix& beta)
 {
     COUNTER("compute_uhat");
-    uhat = F * beta;
+    linop::spmm(uhat, F, beta);
 }
 
 void SparseSideInfo::At_mul_A(Matrix& out)
 {
     COUNTER("At_mul_A");
-    out = Ft * F;
+    out = F.transpose() * F;
+}
+
+void SparseSideInfo::At_mul_A(SparseMatrix& out)
+{
+    COUNTER("At_mul_A sparse");
+    out = F.transpose() * F;
 }
 
 Matrix SparseSideInfo::A_mul_B(Matrix& A)
 {
     COUNTER("A_mul_B");
-    return F.transpose() * A;
+    Matrix out;
+    linop::spmm_t(out, F, A);
+    return out;
+}
+
+void SparseSideInfo::AtA_mul_B(Matrix& out, double reg, const Matrix& B, Matrix& tmp) const
+{
+    COUNTER("AtA_mul_B");
+    linop::AtA_mul_B(out, *this, reg, B, tmp);
 }
 
-int SparseSideInfo::solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error)
+int SparseSideInfo::solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error, PreconditionerTypes preconditioner, bool warm_start)
 {
     COUNTER("solve_blockcg");
-    return linop::solve_blockcg(X, *this, reg, B, tol, blocksize, excess, throw_on_cholesky_error);
+    if (preconditioner == PreconditionerTypes::none)
+        return linop::solve_blockcg(X, *this, reg, B, tol, blocksize, excess, throw_on_cholesky_error, nullptr, warm_start);
+
+    if (!m_preconditioner || m_preconditioner->type() != preconditioner)
+    {
+        COUNTER("preconditioner init");
+        m_preconditioner = std::make_shared<linop::Preconditioner>(preconditioner, *this);
+    }
+
+    {
+        COUNTER("preconditioner compute");
+        m_preconditioner->compute(reg);
+    }
+
+    return linop::solve_blockcg(X, *this, reg, B, tol, blocksize, excess, throw_on_cholesky_error, m_preconditioner.get(), warm_start);
 }
 
-Vector SparseSideInfo::col_square_sum()
+Vector SparseSideInfo::col_square_sum() const
 {
     COUNTER("col_square_sum");
     // component-wise square
@@ -75,13 +103,16 @@ Vector SparseSideInfo::col_square_sum()
 void SparseSideInfo::At_mul_Bt(Vector& Y, const int row, Matrix& B)
 {
     COUNTER("At_mul_Bt");
-    Y = Ft.row(row) * B;
+    Y.setZero(B.cols());
+    for (DualSparseMatrix::ModeIterator it(F, 1, row); it; ++it)
+        Y += it.value() * B.row(it.index());
 }
 
 // computes Z += A[:,row] * b', where a and b are vectors
 void SparseSideInfo::add_Acol_mul_bt(Matrix& Z, const int col, Vector& b)
 {
     COUNTER("add_Acol_mul_bt");
-    Z += F.col(col) * b;
+    for (DualSparseMatrix::ModeIterator it(F, 1, col); it; ++it)
+        Z.row(it.index()) += it.value() * b;
 }
 } // end namespace smurff
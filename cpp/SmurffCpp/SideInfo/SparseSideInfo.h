@@ -4,16 +4,21 @@
 #include <memory>
 #include <SmurffCpp/Types.h>
 #include <SmurffCpp/Configs/DataConfig.h>
+#include <SmurffCpp/DataMatrices/DualSparseMatrix.h>
 
 #include "ISideInfo.h"
 namespace smurff {
 
+namespace linop {
+   class Preconditioner;
+}
+
 class SparseSideInfo : public ISideInfo
 {
 
 public:
-   SparseMatrix F;
-   SparseMatrix Ft;
+   // CSR with a column index, the columns of F are the rows of F'
+   DualSparseMatrix F;
 
    SparseSideInfo(const DataConfig &);
    ~SparseSideInfo() override;
@@ -34,16 +39,23 @@ public:
 
    void At_mul_A(Matrix& out) override;
 
+   void At_mul_A(SparseMatrix& out) override;
+
    Matrix A_mul_B(Matrix& A) override;
 
-   int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false) override;
+   void AtA_mul_B(Matrix& out, double reg, const Matrix& B, Matrix& tmp) const override;
+
+   int solve_blockcg(Matrix& X, double reg, Matrix& B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false, PreconditionerTypes preconditioner = PreconditionerTypes::none, bool warm_start = false) override;
 
-   Vector col_square_sum() override;
+   Vector col_square_sum() const override;
 
    void At_mul_Bt(Vector& Y, const int row, Matrix& B) override;
 
    void add_Acol_mul_bt(Matrix& Z, const int row, Vector& b) override;
 
+private:
+   // kept between solves, only refactored when reg changes
+   std::shared_ptr<linop::Preconditioner> m_preconditioner;
 };
 
 }
@@ -1,9 +1,16 @@
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <limits>
+#include <vector>
+
 #include <SmurffCpp/Types.h>
 #include <Eigen/IterativeLinearSolvers>
 
 #include <SmurffCpp/Utils/MatrixUtils.h>
 #include <SmurffCpp/Utils/Error.h>
 #include <SmurffCpp/Utils/counters.h>
+#include <SmurffCpp/Utils/omp_util.h>
 
 #include <SmurffCpp/SideInfo/SparseSideInfo.h>
 #include "linop.h"
@@ -52,10 +59,9 @@ public:
     return Eigen::Product<AtA, Rhs, Eigen::AliasFreeProduct>(*this, x.derived());
   }
   // Custom API:
-  AtA(const SparseMatrix &A, const SparseMatrix &At, double reg) : m_A(A), m_At(At), m_reg(reg) {}
+  AtA(const SparseMatrix &A, double reg) : m_A(A), m_reg(reg) {}
 
   const SparseMatrix &m_A;
-  const SparseMatrix &m_At;
   double m_reg;
 };
 
@@ -74,7 +80,7 @@ namespace internal {
     static void scaleAndAddTo(Dest& dst, const smurff::linop::AtA& lhs, const Rhs& rhs, const Scalar& alpha)
     {
       // This method should implement "dst += alpha * lhs * rhs" inplace,
-      dst += alpha * ((lhs.m_At * (lhs.m_A * rhs)) + lhs.m_reg * rhs);
+      dst += alpha * ((lhs.m_A.transpose() * (lhs.m_A * rhs)) + lhs.m_reg * rhs);
     }
   };
 }
@@ -90,8 +96,202 @@ inline void makeSymmetric(Matrix &A)
   A = A.selfadjointView<Eigen::Lower>();
 }
 
-inline void AtA_mul_B(Matrix& out, const SparseSideInfo& A, double reg, const Matrix& B) {
-  out.noalias() = (A.Ft * (A.F * B)) + reg * B;
+// calls f(i) for i in [0, n) as tasks: of the current parallel region, or
+// of a new one (update_prior runs as a task, a nested region would get one thread)
+template <typename F>
+static void for_each_task(int n, F f)
+{
+  if (threads::in_parallel())
+  {
+    for (int i = 0; i < n; i++)
+    {
+      #pragma omp task shared(f)
+      f(i);
+    }
+    #pragma omp taskwait
+  }
+  else
+  {
+    #pragma omp parallel
+    #pragma omp single
+    {
+      for (int i = 0; i < n; i++)
+      {
+        #pragma omp task shared(f)
+        f(i);
+      }
+      #pragma omp taskwait
+    }
+  }
+}
+
+// calls f(from, to) for up to 8 ranges per thread that together cover [0, n)
+template <typename F>
+static void for_each_range(int n, F f)
+{
+  const int nranges = std::max(1, std::min(n, 8 * threads::get_max_threads()));
+  for_each_task(nranges, [n, nranges, &f](int r) {
+    f((int)((std::int64_t)n * r / nranges), (int)((std::int64_t)n * (r + 1) / nranges));
+  });
+}
+
+// calls f(from, to) for blocks of the nrows rows with about the same number of
+// nonzeros, begin(i) is the first nonzero of row i, begin(nrows) their number
+template <typename B, typename F>
+static void for_nnz_blocks(int nrows, B begin, F f)
+{
+  const int nblocks = std::max(1, std::min(nrows, 8 * threads::get_max_threads()));
+  const double nnz = begin(nrows);
+
+  std::vector<int> bounds(nblocks + 1);
+  for (int b = 0; b < nblocks; b++)
+  {
+    // first row that starts at or after the share of the blocks before b
+    const double target = nnz * b / nblocks;
+    int lo = 0, hi = nrows;
+    while (lo < hi)
+    {
+      const int mid = lo + (hi - lo) / 2;
+      if (begin(mid) < target) lo = mid + 1; else hi = mid;
+    }
+    bounds[b] = lo;
+  }
+  bounds[nblocks] = nrows;
+
+  for_each_task(nblocks, [&bounds, &f](int b) { f(bounds[b], bounds[b + 1]); });
+}
+
+// calls f(from, to) for blocks of rows of A, with about the same number of nonzeros
+template <typename F>
+static void for_row_blocks(const SparseMatrix & A, F f)
+{
+  THROWERROR_ASSERT(A.isCompressed());
+  const auto *outer = A.outerIndexPtr();
+  for_nnz_blocks(A.rows(), [outer](int i) { return outer[i]; }, f);
+}
+
+void spmm(Matrix & out, const SparseMatrix & A, const Matrix & B)
+{
+  THROWERROR_ASSERT(A.cols() == B.rows());
+  out.resize(A.rows(), B.cols());
+
+  const int ncols = B.cols();
+  for_row_blocks(A, [&out, &A, &B, ncols](int from, int to) {
+    for (int i = from; i < to; i++)
+    {
+      Eigen::Map<Vector> o(out.data() + (std::ptrdiff_t)i * ncols, ncols);
+      o.setZero();
+      for (SparseMatrix::InnerIterator it(A, i); it; ++it)
+        o += it.value() * Eigen::Map<const Vector>(B.data() + (std::ptrdiff_t)it.col() * ncols, ncols);
+    }
+  });
+}
+
+// out = A' * B + reg * C: rows of out are the columns of A, walked with the
+// column index of A, in blocks of columns with about the same number of nonzeros
+static void At_mul_B_plus(Matrix & out, const DualSparseMatrix & A, const Matrix & B, double reg, const Matrix * C)
+{
+  THROWERROR_ASSERT(A.rows() == B.rows());
+  out.resize(A.cols(), B.cols());
+
+  const int ncols = B.cols();
+  for_nnz_blocks(A.cols(), [&A](int i) { return A.begin(1, i); }, [&out, &A, &B, reg, C, ncols](int from, int to) {
+    for (int i = from; i < to; i++)
+    {
+      Eigen::Map<Vector> o(out.data() + (std::ptrdiff_t)i * ncols, ncols);
+      if (C)
+        o = reg * C->row(i);
+      else
+        o.setZero();
+      for (DualSparseMatrix::ModeIterator it(A, 1, i); it; ++it)
+        o += it.value() * Eigen::Map<const Vector>(B.data() + (std::ptrdiff_t)it.index() * ncols, ncols);
+    }
+  });
+}
+
+void spmm_t(Matrix & out, const DualSparseMatrix & A, const Matrix & B)
+{
+  At_mul_B_plus(out, A, B, 0.0, nullptr);
+}
+
+void AtA_mul_B(Matrix & out, const SparseSideInfo & K, double reg, const Matrix & B, Matrix & tmp)
+{
+  THROWERROR_ASSERT(K.cols() == B.rows());
+  spmm(tmp, K.F, B);
+  At_mul_B_plus(out, K.F, tmp, reg, &B);
+}
+
+Preconditioner::Preconditioner(PreconditionerTypes type, const SparseSideInfo& K)
+  : m_type(type), m_reg(std::numeric_limits<double>::quiet_NaN())
+{
+  const int nfeat = K.cols();
+
+  if (m_type == PreconditionerTypes::jacobi)
+  {
+    m_diag = K.col_square_sum();
+  }
+  else if (m_type == PreconditionerTypes::block_jacobi)
+  {
+    const int nblocks = (nfeat + block_size - 1) / block_size;
+    m_blocks.resize(nblocks);
+    m_llt.resize(nblocks);
+
+    // a column major copy of K, only while the blocks are made,
+    // so that the columns of a block are contiguous
+    const Eigen::SparseMatrix<float_type, Eigen::ColMajor> Kc(K.F);
+
+    #pragma omp parallel for schedule(guided)
+    for (int block = 0; block < nblocks; block++)
+    {
+      const int col = block * block_size;
+      const int bcols = std::min(block_size, nfeat - col);
+      const Eigen::SparseMatrix<float_type, Eigen::ColMajor> K_block = Kc.middleCols(col, bcols);
+      const Eigen::SparseMatrix<float_type, Eigen::ColMajor> KtK_block = K_block.transpose() * K_block;
+      m_blocks[block] = Matrix(KtK_block);
+    }
+  }
+  else
+  {
+    THROWERROR("Invalid preconditioner type " + preconditionerTypeToString(type));
+  }
+}
+
+void Preconditioner::compute(double reg)
+{
+  if (reg == m_reg)
+    return;
+
+  m_reg = reg;
+
+  if (m_type == PreconditionerTypes::jacobi)
+  {
+    m_inv_diag = (m_diag.array() + reg).inverse();
+  }
+  else
+  {
+    for_each_task(m_blocks.size(), [this, reg](int block) {
+      Matrix A = m_blocks[block];
+      A.diagonal().array() += reg;
+      m_llt[block].compute(A);
+    });
+  }
+}
+
+void Preconditioner::apply(Matrix & Z, const Matrix & R) const
+{
+  if (m_type == PreconditionerTypes::jacobi)
+  {
+    Z = R.array().colwise() * m_inv_diag.transpose().array();
+  }
+  else
+  {
+    Z.resize(R.rows(), R.cols());
+    for_each_task(m_llt.size(), [this, &Z, &R](int block) {
+      const int row = block * block_size;
+      const int brows = m_blocks[block].rows();
+      Z.middleRows(row, brows) = m_llt[block].solve(R.middleRows(row, brows));
+    });
+  }
 }
 
 //
@@ -101,7 +301,13 @@ inline void AtA_mul_B(Matrix& out, const SparseSideInfo& A, double reg, const Ma
 //   X = n x m matrix
 //   B = n x m matrix
 //
-int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error) {
+//   With a preconditioner, RtR is Z' * R with Z = M^-1 * R, and
+//   the directions P are built from Z instead of R.
+//
+//   With warm_start, X is the initial guess and only the correction
+//   to it is solved for, to the same tolerance relative to B.
+//
+int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error, const Preconditioner *precond, bool warm_start) {
   // initialize
   const int nfeat = B.rows();
   const int nrhs  = B.cols();
@@ -126,6 +332,33 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
   Matrix R(nfeat, nrhs);
   Matrix P(nfeat, nrhs);
   Matrix Ptmp(nfeat, nrhs);
+  Matrix KPtmp(K.rows(), nrhs); // K * P, reused by every iteration
+
+  // initial residual R = B - (K' * K + reg * I) * X0
+  Matrix X0;
+  if (warm_start)
+  {
+    THROWERROR_ASSERT_MSG(X.rows() == nfeat && X.cols() == nrhs, "Initial guess X must have the shape of B");
+    AtA_mul_B(Ptmp, K, reg, X, KPtmp);
+    R = B - Ptmp;
+
+    // columns of the guess that are further off than zero are not used
+    for (int rhs = 0; rhs < nrhs; rhs++)
+    {
+      if (!(R.col(rhs).norm() < norms(rhs)))
+      {
+        X.col(rhs).setZero();
+        R.col(rhs) = B.col(rhs);
+      }
+    }
+    X0.swap(X);
+    X.resize(nfeat, nrhs);
+  }
+  else
+  {
+    R = B;
+  }
+
   X.setZero();
   // normalize R and P:
   #pragma omp parallel for schedule(static) collapse(2)
@@ -133,10 +366,20 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
   {
     for (int rhs = 0; rhs < nrhs; rhs++) 
     {
-      R(feat, rhs) = B(feat, rhs) * inorms(rhs);
+      R(feat, rhs) *= inorms(rhs);
       P(feat, rhs) = R(feat, rhs);
     }
   }
+
+  // preconditioned residual, R itself without preconditioner
+  Matrix Zbuf;
+  if (precond)
+  {
+    precond->apply(Zbuf, R);
+    P = Zbuf;
+  }
+  const Matrix &Z = precond ? Zbuf : R;
+
   Matrix* RtR = new Matrix(nrhs, nrhs);
   Matrix* RtR2 = new Matrix(nrhs, nrhs);
 
@@ -144,19 +387,21 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
   Matrix KPtP(nrhs, nrhs);
   Matrix A;
   Matrix Psi;
+  Vector d = R.colwise().squaredNorm();
 
   //A_mul_At_combo(*RtR, R);
-  *RtR = R.transpose() * R;
+  *RtR = Z.transpose() * R;
   makeSymmetric(*RtR);
 
   const int nblocks = (int)ceil(nfeat / 64.0);
 
-  // CG iteration:
+  // CG iteration, none when the initial guess is good enough:
   int iter = 0;
-  for (iter = 0; iter < 1000; iter++) {
+  bool converged = (d.array() < tolsq).all();
+  for (iter = 0; iter < 1000 && !converged; iter++) {
     // KP = K * P
     ////double t1 = tick();
-    AtA_mul_B(KP, K, reg, P);
+    AtA_mul_B(KP, K, reg, P, KPtmp);
     ////double t2 = tick();
 
     KPtP = KP.transpose() * P;
@@ -167,27 +412,41 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
     ////double t3 = tick();
 
     
-    #pragma omp parallel for schedule(guided)
-    for (int block = 0; block < nblocks; block++) 
-    {
-      int row = block * 64;
-      int brows = std::min(64, nfeat - row);
-      // X += A' * P
-      X.block(row, 0, brows, nrhs).noalias() += P.block(row, 0, brows, nrhs) * A;
-      // R -= A' * KP
-      R.block(row, 0, brows, nrhs).noalias() -= KP.block(row, 0, brows, nrhs) * A;
-    }
+    for_each_range(nblocks, [&](int from, int to) {
+      for (int block = from; block < to; block++) 
+      {
+        int row = block * 64;
+        int brows = std::min(64, nfeat - row);
+        // X += A' * P
+        X.block(row, 0, brows, nrhs).noalias() += P.block(row, 0, brows, nrhs) * A;
+        // R -= A' * KP
+        R.block(row, 0, brows, nrhs).noalias() -= KP.block(row, 0, brows, nrhs) * A;
+      }
+    });
     ////double t4 = tick();
 
     // convergence check:
     //A_mul_At_combo(*RtR2, R);
-    *RtR2 = R.transpose() * R;
-    makeSymmetric(*RtR2);
+    if (precond)
+    {
+      d = R.colwise().squaredNorm();
+      precond->apply(Zbuf, R);
+      *RtR2 = Z.transpose() * R;
+      makeSymmetric(*RtR2);
+    }
+    else
+    {
+      *RtR2 = R.transpose() * R;
+      makeSymmetric(*RtR2);
+      d = RtR2->diagonal();
+    }
 
-    Vector d = RtR2->diagonal();
     // std::cout << "[ iter " << iter << "] " << std::scientific << d.transpose() << " (max: " << d.maxCoeff() << " > " << tolsq << ")" << std::endl;
     //std::cout << iter << ":" << std::scientific << d.transpose() << std::endl;
     if ( (d.array() < tolsq).all()) {
+      // iter counts the iterations done
+      converged = true;
+      iter++;
       break;
     } 
 
@@ -198,16 +457,17 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
     Psi  = chol_RtR.solve(*RtR2);
     ////double t5 = tick();
 
-    // P = R + Psi' * P (P and R are already transposed)
-    #pragma omp parallel for schedule(guided)
-    for (int block = 0; block < nblocks; block++) 
-    {
-      int row = block * 64;
-      int brows = std::min(64, nfeat - row);
-      Matrix xtmp(brows, nrhs);
-      xtmp = P.block(row, 0, brows, nrhs) * Psi;
-      P.block(row, 0, brows, nrhs) = R.block(row, 0, brows, nrhs) + xtmp;
-    }
+    // P = Z + Psi' * P (P and Z are already transposed)
+    for_each_range(nblocks, [&](int from, int to) {
+      Matrix xtmp;
+      for (int block = from; block < to; block++) 
+      {
+        int row = block * 64;
+        int brows = std::min(64, nfeat - row);
+        xtmp.noalias() = P.block(row, 0, brows, nrhs) * Psi;
+        P.block(row, 0, brows, nrhs) = Z.block(row, 0, brows, nrhs) + xtmp;
+      }
+    });
 
     // R R' = R2 R2'
     std::swap(RtR, RtR2);
@@ -218,9 +478,9 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
     ////  (t2-t1)/(t_total), (t3-t2)/(t_total), (t4-t3)/(t_total), (t5-t4)/(t_total), (t6-t5)/(t_total));
   }
   
-  if (iter == 1000)
+  if (!converged)
   {
-    Vector d = RtR2->diagonal().cwiseSqrt();
+    d = d.cwiseSqrt();
     std::cerr << "warning: block_cg: could not find a solution in 1000 iterations; residual: ["
               << d.transpose() << " ].all() > " << tol << std::endl;
   }
@@ -235,41 +495,82 @@ int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix
       X(feat, rhs) *= norms(rhs);
     }
   }
+  if (warm_start)
+  {
+    X += X0;
+  }
   delete RtR;
   delete RtR2;
   return iter;
 }
 
 
-/** good values for solve_blockcg are blocksize=32 an excess=8 */
-int solve_blockcg(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error) {
+void tune_blockcg(int nrhs, int nthreads, int & blocksize, int & excess)
+{
+  // nothing to solve, e.g. on an MPI rank with more ranks than latents
+  if (nrhs <= 0)
+  {
+    blocksize = 1;
+    excess = 0;
+    return;
+  }
+
+  // blocks of at most 32, more and smaller blocks (down to 16) to keep all threads busy
+  const int max_blocksize = 32;
+  const int min_blocksize = 16;
+  const int nblocks = std::max((nrhs + max_blocksize - 1) / max_blocksize,
+                               std::min(nthreads, (nrhs + min_blocksize - 1) / min_blocksize));
+  blocksize = std::max(1, (nrhs + nblocks - 1) / nblocks);
+  excess = blocksize / 4;
+}
+
+/** good values for solve_blockcg are blocksize=32 an excess=8, see tune_blockcg */
+int solve_blockcg(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error, const Preconditioner *precond, bool warm_start) {
   if (B.cols() <= excess + blocksize) {
-    return solve_blockcg_1block(X, K, reg, B, tol, throw_on_cholesky_error);
+    return solve_blockcg_1block(X, K, reg, B, tol, throw_on_cholesky_error, precond, warm_start);
   }
-  // split B into blocks of size <blocksize> (+ excess if needed)
-  Matrix Xblock, Bblock;
-  int max_iter = 0;
+  // split B into blocks of size <blocksize>, the last one takes up to <excess> more
+  std::vector<std::pair<int, int> > blocks;
   for (int i = 0; i < B.cols(); i += blocksize) {
     int ncols = blocksize;
     if (i + ncols + excess >= B.cols()) {
-      ncols = B.cols() - i;
+      blocks.emplace_back(i, B.cols() - i);
+      break;
     }
-    Bblock.resize(B.rows(), ncols);
-    Xblock.resize(X.rows(), ncols);
-
-    Bblock = B.block(0, i, B.rows(), ncols);
-    int niter = solve_blockcg_1block(Xblock, K, reg, Bblock, tol, throw_on_cholesky_error);
-    max_iter = std::max(niter, max_iter);
-    X.block(0, i, X.rows(), ncols) = Xblock;
+    blocks.emplace_back(i, ncols);
   }
 
-  return max_iter;
+  // the blocks are independent, solved concurrently on the shared K and precond
+  // errors cannot leave a task, the first one is thrown afterwards
+  std::vector<int> niter(blocks.size());
+  std::vector<std::exception_ptr> errors(blocks.size());
+  for_each_task(blocks.size(), [&](int b) {
+    try
+    {
+      const int i = blocks[b].first;
+      const int ncols = blocks[b].second;
+      Matrix Bblock = B.middleCols(i, ncols);
+      Matrix Xblock(X.rows(), ncols);
+      if (warm_start) Xblock = X.middleCols(i, ncols);
+      niter[b] = solve_blockcg_1block(Xblock, K, reg, Bblock, tol, throw_on_cholesky_error, precond, warm_start);
+      X.middleCols(i, ncols) = Xblock;
+    }
+    catch (...)
+    {
+      errors[b] = std::current_exception();
+    }
+  });
+
+  for (auto &e : errors)
+    if (e) std::rethrow_exception(e);
+
+  return *std::max_element(niter.begin(), niter.end());
 }
 
 int solve_blockcg_eigen(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error)
 {
    COUNTER("eigen_cg");
-   linop::AtA A(K.F, K.Ft, reg);
+   linop::AtA A(K.F, reg);
    Eigen::ConjugateGradient<linop::AtA, Eigen::Lower | Eigen::Upper, Eigen::IdentityPreconditioner> cg;
    cg.setTolerance(tol);
    cg.compute(A);
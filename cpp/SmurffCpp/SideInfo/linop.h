@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <SmurffCpp/Types.h>
 #include <SmurffCpp/Types.h>
 #include <Eigen/IterativeLinearSolvers>
@@ -14,17 +16,69 @@ namespace smurff {
 namespace linop {
 
 
+//
+//-- Sparse times dense products, for side info with many rows or features
+//   rows of out are computed in parallel, in blocks with about the same
+//   number of nonzeros: tasks inside a parallel region, a new region otherwise
+//
+//   out = A * B
+void spmm(Matrix & out, const SparseMatrix & A, const Matrix & B);
+
+//   out = A' * B, A' is not formed: the column index of A gives its rows
+void spmm_t(Matrix & out, const DualSparseMatrix & A, const Matrix & B);
+
+//   out = K' * (K * B) + reg * B, with tmp = K * B, reusing out and tmp when
+//   they have the right size
+void AtA_mul_B(Matrix & out, const SparseSideInfo & K, double reg, const Matrix & B, Matrix & tmp);
+
+//
+//-- M^-1 for the preconditioned block CG, M approximates K' * K + reg * I
+//   jacobi:       M is its diagonal
+//   block_jacobi: M are its diagonal blocks of block_size features
+//
+class Preconditioner
+{
+public:
+  static const int block_size = 64;
+
+  // the parts of K' * K that do not depend on reg
+  Preconditioner(PreconditionerTypes type, const SparseSideInfo& K);
+
+  PreconditionerTypes type() const { return m_type; }
+
+  // (re)factors M, only when reg changed
+  void compute(double reg);
+
+  // Z = M^-1 * R
+  void apply(Matrix & Z, const Matrix & R) const;
+
+private:
+  PreconditionerTypes m_type;
+  double m_reg;
+
+  Vector m_diag;                          // the column square sums of K
+  Vector m_inv_diag;
+  std::vector<Matrix> m_blocks;           // diagonal blocks of K' * K
+  std::vector<Eigen::LLT<Matrix> > m_llt; // of the blocks + reg * I
+};
+
 //
 //-- Solves the system (K' * K + reg * I) * X = B for X for m right-hand sides
 //   K = d x n matrix
 //   I = n x n identity
 //   X = n x m matrix
 //   B = n x m matrix
+//   precond = M^-1, none if nullptr
+//   warm_start = X is the initial guess instead of zero
 //
-int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error = false);
+int solve_blockcg_1block(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error = false, const Preconditioner *precond = nullptr, bool warm_start = false);
+
+/** blocksize and excess for nrhs right-hand sides on nthreads threads */
+void tune_blockcg(int nrhs, int nthreads, int & blocksize, int & excess);
 
-/** good values for solve_blockcg are blocksize=32 an excess=8 */
-int solve_blockcg(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false);
+/** good values for solve_blockcg are blocksize=32 an excess=8, see tune_blockcg
+    the blocks are solved concurrently */
+int solve_blockcg(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, const int blocksize, const int excess, bool throw_on_cholesky_error = false, const Preconditioner *precond = nullptr, bool warm_start = false);
 
 int solve_blockcg_eigen(Matrix & X, const SparseSideInfo& K, double reg, Matrix & B, double tol, bool throw_on_cholesky_error = false);
 
@@ -145,7 +145,8 @@ double rand_gamma(double shape, double scale)
 
 //#define TEST_MVNORMAL
 
-Matrix WishartUnit(int m, int df)
+// Bartlett decomposition: the upper triangular c with c' * c a sample of the unit Wishart distribution
+static Matrix WishartUnitChol(int m, int df)
 {
    Matrix c(m,m);
    c.setZero();
@@ -157,37 +158,29 @@ Matrix WishartUnit(int m, int df)
       c.block(i,i+1,1,m-i-1) = RandomVectorExpr(m-i-1);
    }
 
-   Matrix ret = c.transpose() * c;
-
    #ifdef TEST_MVNORMAL
    std::cout << "WISHART UNIT {\n" << std::endl;
    std::cout << "  m:\n" << m << std::endl;
    std::cout << "  df:\n" << df << std::endl;
-   std::cout << "  ret;\n" << ret << std::endl;
    std::cout << "  c:\n" << c << std::endl;
    std::cout << "}\n" << std::endl;
    #endif
 
-   return ret;
+   return c;
 }
 
-Matrix Wishart(const Matrix &sigma, const int df)
+// lower Cholesky factor of a sample of Wishart(sigma, df), with sigma = L * L'
+Matrix WishartChol(const Matrix &L, const int df)
 {
-   //  Get R, the upper triangular Cholesky factor of SIGMA.
-   auto chol = sigma.llt();
-   Matrix r = chol.matrixL();
-
-   //  Get AU, a sample from the unit Wishart distribution.
-   Matrix au = WishartUnit(sigma.rows(), df);
+   //  Get C, with C' * C a sample from the unit Wishart distribution.
+   Matrix c = WishartUnitChol(L.rows(), df);
 
-   //  Construct the matrix A = R' * AU * R.
-   Matrix a = r * au * chol.matrixU();
+   //  A = L * C' * C * L', and L * C' is lower triangular with a positive diagonal.
+   Matrix a = L.triangularView<Eigen::Lower>() * c.transpose();
 
    #ifdef TEST_MVNORMAL
    std::cout << "WISHART {\n" << std::endl;
-   std::cout << "  sigma:\n" << sigma << std::endl;
-   std::cout << "  r:\n" << r << std::endl;
-   std::cout << "  au:\n" << au << std::endl;
+   std::cout << "  L:\n" << L << std::endl;
    std::cout << "  df:\n" << df << std::endl;
    std::cout << "  a:\n" << a << std::endl;
    std::cout << "}\n" << std::endl;
@@ -197,35 +190,51 @@ Matrix Wishart(const Matrix &sigma, const int df)
 }
 
 // from julia package Distributions: conjugates/normalwishart.jl
-std::pair<Vector, Matrix> NormalWishart(const Vector & mu, double kappa, const Matrix & T, const int nu)
+std::tuple<Vector, Matrix, Matrix> NormalWishartChol(const Vector & mu, double kappa, const Matrix & L, const int nu)
 {
-   Matrix Lam = Wishart(T, nu);
-   Matrix mu_o = MvNormal(Lam * kappa, mu);
+   Matrix Lam_L = WishartChol(L, nu);
+   Matrix Lam = Lam_L * Lam_L.transpose();
+   Matrix mu_o = MvNormalChol(Lam_L * std::sqrt(kappa), mu);
 
    #ifdef TEST_MVNORMAL
    std::cout << "NORMAL WISHART {\n" << std::endl;
    std::cout << "  mu:\n" << mu << std::endl;
    std::cout << "  kappa:\n" << kappa << std::endl;
-   std::cout << "  T:\n" << T << std::endl;
+   std::cout << "  L:\n" << L << std::endl;
    std::cout << "  nu:\n" << nu << std::endl;
    std::cout << "  mu_o\n" << mu_o << std::endl;
    std::cout << "  Lam\n" << Lam << std::endl;
    std::cout << "}\n" << std::endl;
    #endif
 
-   return std::make_pair(mu_o , Lam);
+   return std::make_tuple(mu_o, Lam, Lam_L);
 }
 
-std::pair<Vector, Matrix> CondNormalWishart(const int N, const Matrix &NS, const Vector &NU, const Vector &mu, const double kappa, const Matrix &T, const int nu)
+std::pair<Vector, Matrix> NormalWishart(const Vector & mu, double kappa, const Matrix & T, const int nu)
+{
+   Matrix L = T.llt().matrixL();
+   const auto ret = NormalWishartChol(mu, kappa, L, nu);
+   return std::make_pair(std::get<0>(ret), std::get<1>(ret));
+}
+
+std::tuple<Vector, Matrix, Matrix> CondNormalWishartChol(const int N, const Matrix &NS, const Vector &NU, const Vector &mu, const double kappa, const Matrix &T, const int nu)
 {
    int nu_c = nu + N;
 
    double kappa_c = kappa + N;
    auto mu_c = (kappa * mu + NU) / (kappa + N);
-   auto X    = T + NS + kappa * mu.transpose() * mu - kappa_c * mu_c.transpose() * mu_c;
-   Matrix T_c = X.inverse();
+   Matrix X  = T + NS + kappa * mu.transpose() * mu - kappa_c * mu_c.transpose() * mu_c;
+
+   // The scale matrix is X^-1. With J the exchange matrix, J * X * J = R * R',
+   // X = (J * R * J) * (J * R * J)' and X^-1 = L * L' with L = J * R^-T * J,
+   // which is lower triangular: the Cholesky factor of X^-1 without inverting X.
+   const int K = X.rows();
+   Eigen::LLT<Matrix> chol(X.reverse());
+   Matrix Rinv = Matrix::Identity(K, K);
+   chol.matrixL().solveInPlace(Rinv);
+   Matrix L_c = Rinv.transpose().reverse();
     
-   const auto ret = NormalWishart(mu_c, kappa_c, T_c, nu_c);
+   const auto ret = NormalWishartChol(mu_c, kappa_c, L_c, nu_c);
 
 #ifdef TEST_MVNORMAL
    std::cout << "CondNormalWishart/7 {\n" << std::endl;
@@ -236,15 +245,15 @@ std::pair<Vector, Matrix> CondNormalWishart(const int N, const Matrix &NS, const
    std::cout << "  N:\n" << N << std::endl;
    std::cout << "  NS:\n" << NS << std::endl;
    std::cout << "  NU:\n" << NU << std::endl;
-   std::cout << "  mu_o\n" << ret.first << std::endl;
-   std::cout << "  Lam\n" << ret.second << std::endl;
+   std::cout << "  mu_o\n" << std::get<0>(ret) << std::endl;
+   std::cout << "  Lam\n" << std::get<1>(ret) << std::endl;
    std::cout << "}\n" << std::endl;
 #endif
 
    return ret;
 }
 
-std::pair<Vector, Matrix> CondNormalWishart(const Matrix &U, const Vector &mu, const double kappa, const Matrix &T, const int nu)
+std::tuple<Vector, Matrix, Matrix> CondNormalWishartChol(const Matrix &U, const Vector &mu, const double kappa, const Matrix &T, const int nu)
 {
    auto N = U.rows();
    auto NS = U.transpose() * U;
@@ -256,47 +265,61 @@ std::pair<Vector, Matrix> CondNormalWishart(const Matrix &U, const Vector &mu, c
    std::cout << "}\n" << std::endl;
 #endif
 
-   return CondNormalWishart(N, NS, NU, mu, kappa, T, nu);
+   return CondNormalWishartChol(N, NS, NU, mu, kappa, T, nu);
 }
 
-// Normal(0, Lambda^-1) for nn columns
-Matrix MvNormal(const Matrix & Lambda, int num_samples)
+std::pair<Vector, Matrix> CondNormalWishart(const int N, const Matrix &NS, const Vector &NU, const Vector &mu, const double kappa, const Matrix &T, const int nu)
+{
+   const auto ret = CondNormalWishartChol(N, NS, NU, mu, kappa, T, nu);
+   return std::make_pair(std::get<0>(ret), std::get<1>(ret));
+}
+
+std::pair<Vector, Matrix> CondNormalWishart(const Matrix &U, const Vector &mu, const double kappa, const Matrix &T, const int nu)
+{
+   const auto ret = CondNormalWishartChol(U, mu, kappa, T, nu);
+   return std::make_pair(std::get<0>(ret), std::get<1>(ret));
+}
+
+// Normal(0, Lambda^-1) for nn columns, with Lambda = L * L'
+Matrix MvNormalChol(const Matrix & L, int num_samples)
 {
-   int ndims = Lambda.rows(); // Dimensionality 
-   Eigen::LLT<Matrix> chol(Lambda);
+   int ndims = L.rows(); // Dimensionality 
 
    Matrix r(num_samples, ndims);
    rand_normal(r);
-   Matrix ret = chol.matrixU().solve(r.transpose()).transpose();
+
+   // r * L^-1, each row has covariance L^-T * L^-1 = Lambda^-1
+   Matrix ret = L.triangularView<Eigen::Lower>().solve<Eigen::OnTheRight>(r);
 
 #ifdef TEST_MVNORMAL
    std::cout << "MvNormal/2 {\n" << std::endl;
-   std::cout << "  Lambda\n" << Lambda << std::endl;
-   std::cout << "  nrows\n" << nrows << std::endl;
+   std::cout << "  L\n" << L << std::endl;
+   std::cout << "  num_samples\n" << num_samples << std::endl;
    std::cout << "  ret\n" << ret << std::endl;
    std::cout << "}\n" << std::endl;
 #endif
 
    return ret;
-
 }
 
-Matrix MvNormal(const Matrix & Lambda, const Vector & mean, int num_samples)
+Matrix MvNormalChol(const Matrix & L, const Vector & mean, int num_samples)
 {
-   Matrix r = MvNormal(Lambda, num_samples);
+   Matrix r = MvNormalChol(L, num_samples);
    r.rowwise() += mean;
-  
-#ifdef TEST_MVNORMAL
-   THROWERROR_ASSERT(r.rows() == nrows);
-   std::cout << "MvNormal/2 {\n" << std::endl;
-   std::cout << "  Lambda\n" << Lambda << std::endl;
-   std::cout << "  mean\n" << mean << std::endl;
-   std::cout << "  nrows\n" << nrows << std::endl;
-   std::cout << "  r\n" << r << std::endl;
-   std::cout << "}\n" << std::endl;
-#endif
-
    return r;
 }
 
+// Normal(0, Lambda^-1) for nn columns
+Matrix MvNormal(const Matrix & Lambda, int num_samples)
+{
+   Matrix L = Lambda.llt().matrixL();
+   return MvNormalChol(L, num_samples);
+}
+
+Matrix MvNormal(const Matrix & Lambda, const Vector & mean, int num_samples)
+{
+   Matrix L = Lambda.llt().matrixL();
+   return MvNormalChol(L, mean, num_samples);
+}
+
 } // end namespace smurff
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <tuple>
 
 #include <SmurffCpp/Types.h>
 #include <SmurffCpp/Types.h>
@@ -34,9 +35,21 @@ namespace smurff
    std::pair<Vector, Matrix> NormalWishart(const Vector & mu, double kappa, const Matrix & T, double nu);
    std::pair<Vector, Matrix> CondNormalWishart(const Matrix &U, const Vector &mu, const double kappa, const Matrix &T, const int nu);
    std::pair<Vector, Matrix> CondNormalWishart(const int N, const Matrix &NS, const Vector &NU, const Vector &mu, const double kappa, const Matrix &T, const int nu);
+
+   // Same on Cholesky factors: a matrix A is passed as its lower Cholesky factor L, A = L * L^T.
+   // Return mu, Lambda and the factor of Lambda, so that Lambda is never factored again.
+
+   Matrix WishartChol(const Matrix & L, const int df);
+   std::tuple<Vector, Matrix, Matrix> NormalWishartChol(const Vector & mu, double kappa, const Matrix & L, const int nu);
+   std::tuple<Vector, Matrix, Matrix> CondNormalWishartChol(const Matrix &U, const Vector &mu, const double kappa, const Matrix &T, const int nu);
+   std::tuple<Vector, Matrix, Matrix> CondNormalWishartChol(const int N, const Matrix &NS, const Vector &NU, const Vector &mu, const double kappa, const Matrix &T, const int nu);
    
    // Multivariate normal gaussian
 
    Matrix MvNormal(const Matrix & Lambda, int nn = 1);
    Matrix MvNormal(const Matrix & Lambda, const Vector & mean, int nn = 1);
+
+   // Normal(0, Lambda^-1) with Lambda = L * L^T
+   Matrix MvNormalChol(const Matrix & L, int nn = 1);
+   Matrix MvNormalChol(const Matrix & L, const Vector & mean, int nn = 1);
 }
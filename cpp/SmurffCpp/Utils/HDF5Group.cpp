@@ -147,6 +147,43 @@ void HDF5Group::write(const std::string& section, const std::string& tag, const
    indices.write(X.innerIndexPtr());
 }
 
+void HDF5Group::create(const std::string& section, const std::string& tag, std::size_t rows, std::size_t cols)
+{
+   if (!m_group.exist(section))
+      m_group.createGroup(section);
+
+   m_group.getGroup(section).createDataSet<Matrix::Scalar>(tag, h5::DataSpace({rows, cols}));
+}
+
+std::vector<std::size_t> HDF5Group::dims(const std::string& section, const std::string& tag) const
+{
+   return m_group.getGroup(section).getDataSet(tag).getDimensions();
+}
+
+// rows [row, row + M.rows()) of a dataset made with create()
+void HDF5Group::write(const std::string& section, const std::string& tag, std::size_t row, const Eigen::Ref<const Matrix> &M)
+{
+   static_assert(Matrix::IsRowMajor, "blocks of rows are contiguous in a row-major Matrix");
+
+   auto dataset = m_group.getGroup(section).getDataSet(tag);
+   std::vector<size_t> dims = dataset.getDimensions();
+   THROWERROR_ASSERT(row + M.rows() <= dims[0] && (size_t)M.cols() == dims[1] && M.outerStride() == M.cols());
+
+   dataset.select({row, 0}, {static_cast<size_t>(M.rows()), dims[1]}).write_raw(M.data());
+}
+
+// fills X, which has the size of the block, from rows [row, row + X.rows())
+void HDF5Group::read(const std::string& section, const std::string& tag, std::size_t row, Eigen::Ref<Matrix> X) const
+{
+   static_assert(Matrix::IsRowMajor, "blocks of rows are contiguous in a row-major Matrix");
+
+   auto dataset = m_group.getGroup(section).getDataSet(tag);
+   std::vector<size_t> dims = dataset.getDimensions();
+   THROWERROR_ASSERT(row + X.rows() <= dims[0] && (size_t)X.cols() == dims[1] && X.outerStride() == X.cols());
+
+   dataset.select({row, 0}, {static_cast<size_t>(X.rows()), dims[1]}).read(X.data());
+}
+
 void HDF5Group::write(const std::string& section, const std::string& tag, const DenseTensor &X)
 {
    THROWERROR_NOTIMPL();
@@ -97,5 +97,11 @@ namespace smurff {
       void write(const std::string &section, const std::string& tag, const SparseMatrix &);
       void write(const std::string &section, const std::string& tag, const DenseTensor &);
       void write(const std::string &section, const std::string& tag, const SparseTensor &);
+
+      // dense datasets too large to hold in memory, written and read in blocks of rows
+      void create(const std::string &section, const std::string& tag, std::size_t rows, std::size_t cols);
+      std::vector<std::size_t> dims(const std::string &section, const std::string& tag) const;
+      void write(const std::string &section, const std::string& tag, std::size_t row, const Eigen::Ref<const Matrix> &);
+      void read(const std::string &section, const std::string& tag, std::size_t row, Eigen::Ref<Matrix>) const;
    };
 }
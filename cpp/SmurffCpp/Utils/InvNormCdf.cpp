@@ -55,6 +55,8 @@
 #include <cmath>
 #include <limits>
 
+#include "InvNormCdf.h"
+
 /* std::sqrt(2pi) */
 static double s2pi = 2.50662827463100050242E0;
 
@@ -211,3 +213,36 @@ double inv_norm_cdf(double y0)
     x = -x;
   return (x);
 }
+
+/*
+ * Rational approximation by P. J. Acklam, evaluated for a whole array at
+ * once: both the central and the tail approximation are computed and
+ * selected per element, so the loop has no branches and vectorizes.
+ */
+smurff::Array1D approx_inv_norm_cdf(const smurff::Array1D &y)
+{
+  typedef smurff::Array1D A;
+  static const double a[6] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+  static const double b[5] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                6.680131188771972e+01, -1.328068155288572e+01 };
+  static const double c[6] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+  static const double d[4] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                3.754408661907416e+00 };
+  static const double y_low = 0.02425;
+
+  // central region
+  const A q = y - 0.5;
+  const A r = q * q;
+  const A central = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+                    (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+
+  // tails, the upper one by symmetry
+  const A yt = y.min(1.0 - y).max(std::numeric_limits<double>::min());
+  const A s = (-2.0 * yt.log()).sqrt();
+  const A tail = (((((c[0] * s + c[1]) * s + c[2]) * s + c[3]) * s + c[4]) * s + c[5]) /
+                 ((((d[0] * s + d[1]) * s + d[2]) * s + d[3]) * s + 1.0);
+
+  return (yt < y_low).select((y < 0.5).select(tail, -tail), central);
+}
@@ -1,3 +1,8 @@
 #pragma once
 
+#include <SmurffCpp/Types.h>
+
 double inv_norm_cdf(double y0);
+
+// vectorized approximation of inv_norm_cdf, relative error < 1.2e-9 on (0, 1)
+smurff::Array1D approx_inv_norm_cdf(const smurff::Array1D &y);
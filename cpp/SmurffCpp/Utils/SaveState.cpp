@@ -129,21 +129,35 @@ void SaveState::putMu(std::uint64_t index, const Matrix &M)
 
 bool SaveState::hasAggr(std::uint64_t index) const
 {
-   return hasDataSet(LATENTS_SEC_TAG, POST_NUM_PREFIX + std::to_string(index));
+   // the number of samples is an attribute, look for the sums
+   return hasDataSet(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index));
 }
 
-void SaveState::readAggr(std::uint64_t index, int &num, Matrix &sum, Matrix &dot) const
+void SaveState::readAggrInfo(std::uint64_t index, int &num, std::size_t &rows, std::size_t &dot_cols) const
 {
    m_group.getGroup(LATENTS_SEC_TAG).getAttribute(POST_NUM_PREFIX + std::to_string(index)).read(num);
-   read(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index), sum);
-   read(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index), dot);
+   auto dot_dims = dims(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index));
+   rows = dot_dims.at(0);
+   dot_cols = dot_dims.at(1);
 }
 
-void SaveState::putAggr(std::uint64_t index, int num, const Matrix &sum, const Matrix &dot)
+void SaveState::readAggr(std::uint64_t index, std::size_t row, Eigen::Ref<Matrix> sum, Eigen::Ref<Matrix> dot) const
 {
+   read(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index), row, sum);
+   read(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index), row, dot);
+}
+
+void SaveState::createAggr(std::uint64_t index, int num, std::size_t rows, std::size_t sum_cols, std::size_t dot_cols)
+{
+   create(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index), rows, sum_cols);
+   create(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index), rows, dot_cols);
    m_group.getGroup(LATENTS_SEC_TAG).createAttribute(POST_NUM_PREFIX + std::to_string(index), num);
-   write(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index), sum);
-   write(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index), dot);
+}
+
+void SaveState::putAggr(std::uint64_t index, std::size_t row, const Eigen::Ref<const Matrix> &sum, const Eigen::Ref<const Matrix> &dot)
+{
+   write(LATENTS_SEC_TAG, POST_SUM_PREFIX + std::to_string(index), row, sum);
+   write(LATENTS_SEC_TAG, POST_DOT_PREFIX + std::to_string(index), row, dot);
 }
 
 void SaveState::readPostMuLambda(std::uint64_t index, Matrix &mu, Matrix &Lambda) const
@@ -152,10 +166,16 @@ void SaveState::readPostMuLambda(std::uint64_t index, Matrix &mu, Matrix &Lambda
    read(LATENTS_SEC_TAG, POST_LAMBDA_PREFIX + std::to_string(index), Lambda);
 }
 
-void SaveState::putPostMuLambda(std::uint64_t index, const Matrix &mu, const Matrix &Lambda)
+void SaveState::createPostMuLambda(std::uint64_t index, std::size_t rows, std::size_t mu_cols, std::size_t lambda_cols)
+{
+   create(LATENTS_SEC_TAG, POST_MU_PREFIX + std::to_string(index), rows, mu_cols);
+   create(LATENTS_SEC_TAG, POST_LAMBDA_PREFIX + std::to_string(index), rows, lambda_cols);
+}
+
+void SaveState::putPostMuLambda(std::uint64_t index, std::size_t row, const Eigen::Ref<const Matrix> &mu, const Eigen::Ref<const Matrix> &Lambda)
 {
-   write(LATENTS_SEC_TAG, POST_MU_PREFIX + std::to_string(index), mu);
-   write(LATENTS_SEC_TAG, POST_LAMBDA_PREFIX + std::to_string(index), Lambda);
+   write(LATENTS_SEC_TAG, POST_MU_PREFIX + std::to_string(index), row, mu);
+   write(LATENTS_SEC_TAG, POST_LAMBDA_PREFIX + std::to_string(index), row, Lambda);
 }
 
 
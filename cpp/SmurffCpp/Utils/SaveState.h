@@ -43,7 +43,8 @@ namespace smurff {
       void readModel(std::uint64_t index, Matrix &) const;
       void readMu(std::uint64_t index, Vector &) const;
       void readLinkMatrix(std::uint32_t index, Matrix &) const;
-      void readAggr(std::uint64_t index, int &, Matrix &, Matrix &) const;
+      void readAggrInfo(std::uint64_t index, int &num, std::size_t &rows, std::size_t &dot_cols) const;
+      void readAggr(std::uint64_t index, std::size_t row, Eigen::Ref<Matrix> sum, Eigen::Ref<Matrix> dot) const;
       void readPostMuLambda(std::uint64_t index, Matrix &, Matrix &) const;
 
       void getPredState(double &rmse_avg, double &rmse_1sample, double &auc_avg, double &auc_1sample, int &sample_iter, int &burnin_iter) const;
@@ -53,8 +54,11 @@ namespace smurff {
       void readPredVar(Matrix &) const;
 
       void putModel(const std::vector<Matrix> &);
-      void putAggr(std::uint64_t index, const int, const Matrix &, const Matrix &);
-      void putPostMuLambda(std::uint64_t index, const Matrix &, const Matrix &);
+      // aggregates and posteriors are written in blocks of rows, after creating the datasets
+      void createAggr(std::uint64_t index, int num, std::size_t rows, std::size_t sum_cols, std::size_t dot_cols);
+      void putAggr(std::uint64_t index, std::size_t row, const Eigen::Ref<const Matrix> &sum, const Eigen::Ref<const Matrix> &dot);
+      void createPostMuLambda(std::uint64_t index, std::size_t rows, std::size_t mu_cols, std::size_t lambda_cols);
+      void putPostMuLambda(std::uint64_t index, std::size_t row, const Eigen::Ref<const Matrix> &mu, const Eigen::Ref<const Matrix> &Lambda);
 
       void putMu(std::uint64_t index, const Matrix &);
       void putLinkMatrix(std::uint64_t mode, const Matrix &);
@@ -0,0 +1,87 @@
+#include "ScratchArena.h"
+
+#include <algorithm>
+
+#include <SmurffCpp/Utils/Error.h>
+
+namespace smurff {
+
+const std::size_t ScratchArena::alignment;
+
+ScratchArena::Frame::Frame(ScratchArena &arena)
+   : m_arena(arena), m_top(arena.m_top), m_noverflow(arena.m_overflow.size())
+{
+}
+
+ScratchArena::Frame::~Frame()
+{
+   m_arena.m_top = m_top;
+   while (m_arena.m_overflow.size() > m_noverflow)
+   {
+      m_arena.m_overflow_bytes -= m_arena.m_overflow.back().size();
+      m_arena.m_overflow.pop_back();
+   }
+}
+
+ScratchArena::ScratchArena(std::size_t bytes)
+{
+   reserve(bytes);
+}
+
+void ScratchArena::reserve(std::size_t bytes)
+{
+   THROWERROR_ASSERT_MSG(used() == 0, "ScratchArena::reserve called while in use");
+
+   // the buffer is only aligned to the Eigen alignment, leave room to align the first block
+   bytes = round_up(bytes) + alignment;
+   if (bytes > m_buffer.size())
+   {
+      Buffer(bytes).swap(m_buffer);
+   }
+}
+
+void ScratchArena::reset()
+{
+   THROWERROR_ASSERT_MSG(used() == 0, "ScratchArena::reset called while in use");
+
+   m_overflow.clear();
+   m_overflow.shrink_to_fit();
+   // reset() may run on another thread, leave the regrow to the first allocate()
+   if (m_peak + alignment > m_buffer.size())
+      m_grow = std::max(m_grow, m_peak);
+   m_peak = 0;
+}
+
+void *ScratchArena::allocate_bytes(std::size_t bytes)
+{
+   if (m_grow && used() == 0)
+   {
+      reserve(m_grow);
+      m_grow = 0;
+   }
+
+   bytes = round_up(std::max(bytes, (std::size_t)1));
+
+   const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(m_buffer.data());
+   const std::size_t offset = round_up(base + m_top) - base;
+
+   void *ptr;
+   if (offset + bytes <= m_buffer.size())
+   {
+      ptr = m_buffer.data() + offset;
+      m_top = offset + bytes;
+   }
+   else
+   {
+      m_noverflows++;
+      m_overflow.emplace_back(bytes + alignment);
+      m_overflow_bytes += m_overflow.back().size();
+      const std::uintptr_t obase = reinterpret_cast<std::uintptr_t>(m_overflow.back().data());
+      ptr = reinterpret_cast<void *>(round_up(obase));
+   }
+
+   m_peak = std::max(m_peak, used());
+   return ptr;
+}
+
+} // end namespace smurff
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <SmurffCpp/Types.h>
+
+namespace smurff {
+
+// Bump allocator for the temporaries of one thread in the sampling hot path.
+//
+// Memory is taken with allocate(), vector() or matrix() inside a Frame and is
+// given back when the Frame goes out of scope, so frames must nest like the
+// call stack. Requests that do not fit in the buffer go to the heap and are
+// counted as overflows; after the next reset() the first allocation grows the
+// buffer to the peak use, so the pages are touched by the thread that uses them.
+class ScratchArena
+{
+public:
+   // every allocation starts on its own cache line
+   static const std::size_t alignment = 64;
+
+   class Frame
+   {
+   private:
+      ScratchArena &m_arena;
+      const std::size_t m_top;
+      const std::size_t m_noverflow;
+
+   public:
+      Frame(ScratchArena &arena);
+      ~Frame();
+
+      Frame(const Frame &) = delete;
+      Frame &operator=(const Frame &) = delete;
+   };
+
+private:
+   typedef std::vector<char, Eigen::aligned_allocator<char> > Buffer;
+
+   Buffer m_buffer;
+   std::size_t m_top = 0; // bytes in use in m_buffer
+
+   std::vector<Buffer> m_overflow; // blocks that did not fit in m_buffer
+   std::size_t m_overflow_bytes = 0;
+   std::size_t m_peak = 0; // most bytes in use since the last reset
+   std::size_t m_grow = 0; // buffer size wanted at the next allocation from empty
+   std::uint64_t m_noverflows = 0;
+
+public:
+   ScratchArena(std::size_t bytes = 0);
+
+   // make sure at least bytes fit without overflow, only when nothing is in use
+   void reserve(std::size_t bytes);
+
+   // releases everything and schedules growing the buffer to the peak use, only when no Frame is alive
+   void reset();
+
+   void *allocate_bytes(std::size_t bytes);
+
+   template<typename T>
+   T *allocate(std::size_t n)
+   {
+      return static_cast<T *>(allocate_bytes(n * sizeof(T)));
+   }
+
+   Eigen::Map<Vector> vector(Eigen::Index n)
+   {
+      return Eigen::Map<Vector>(allocate<float_type>(n), n);
+   }
+
+   Eigen::Map<Matrix> matrix(Eigen::Index rows, Eigen::Index cols)
+   {
+      return Eigen::Map<Matrix>(allocate<float_type>(rows * cols), rows, cols);
+   }
+
+public:
+   std::size_t capacity() const { return m_buffer.size(); }
+   std::size_t used() const { return m_top + m_overflow_bytes; }
+   std::uint64_t overflows() const { return m_noverflows; }
+
+   // bytes taken by n objects of type T, including the alignment padding
+   template<typename T>
+   static std::size_t footprint(std::size_t n)
+   {
+      return round_up(n * sizeof(T));
+   }
+
+private:
+   static std::size_t round_up(std::size_t bytes)
+   {
+      return (bytes + alignment - 1) / alignment * alignment;
+   }
+};
+
+} // end namespace smurff
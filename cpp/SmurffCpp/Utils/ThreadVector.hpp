@@ -4,35 +4,116 @@
 #include <numeric>
 #include <vector>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
 
 #include "omp_util.h"
 
+namespace threads
+{
+// size of a cache line, per-thread data is kept this far apart
+static const std::size_t cache_line_size = 64;
+
+// std::allocator only guarantees the alignment of max_align_t before C++17
+template <typename T>
+struct cache_line_allocator
+{
+    typedef T value_type;
+
+    cache_line_allocator() = default;
+    template <typename U>
+    cache_line_allocator(const cache_line_allocator<U> &) {}
+
+    T *allocate(std::size_t n)
+    {
+        // room to align and to keep the pointer that was allocated in front
+        void *raw = ::operator new(n * sizeof(T) + cache_line_size + sizeof(void *));
+        const std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *) + cache_line_size - 1) & ~(cache_line_size - 1);
+        reinterpret_cast<void **>(p)[-1] = raw;
+        return reinterpret_cast<T *>(p);
+    }
+
+    void deallocate(T *p, std::size_t)
+    {
+        ::operator delete(reinterpret_cast<void **>(p)[-1]);
+    }
+
+    template <typename U>
+    bool operator==(const cache_line_allocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const cache_line_allocator<U> &) const { return false; }
+};
+} // namespace threads
+
+// One T per thread, indexed by the OpenMP thread number.
+//
+// Every element sits on its own cache lines so that threads updating their
+// element do not false-share. init() makes each element on the thread that
+// owns it, so that heap memory held by T (the data of an Eigen matrix) is
+// first touched, and placed, on the NUMA node of that thread. The constructor
+// does not start threads, it can run during static initialization.
 template <typename T>
 class thread_vector
 {
+private:
+    struct alignas(threads::cache_line_size) Slot
+    {
+        T value;
+
+        Slot() = default;
+        Slot(const T &t) : value(t) {}
+    };
+
+    typedef std::vector<Slot, threads::cache_line_allocator<Slot> > Slots;
+
+    template <typename It, typename V>
+    class slot_iterator
+    {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef V value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef V *pointer;
+        typedef V &reference;
+
+        slot_iterator(It it) : _it(it) {}
+
+        reference operator*() const { return _it->value; }
+        pointer operator->() const { return &_it->value; }
+        slot_iterator &operator++() { ++_it; return *this; }
+        slot_iterator operator++(int) { slot_iterator ret(*this); ++_it; return ret; }
+        bool operator==(const slot_iterator &other) const { return _it == other._it; }
+        bool operator!=(const slot_iterator &other) const { return _it != other._it; }
+
+    private:
+        It _it;
+    };
+
 public:
     thread_vector(const T &t = T())
+        : _m(threads::get_max_threads(), Slot(t)), _i(t)
     {
-        init(t);
     }
     template <typename F>
     T combine(F f) const
     {
-        return std::accumulate(_m.begin(), _m.end(), _i, f);
+        return std::accumulate(begin(), end(), _i, f);
     }
     T combine() const
     {
-        return std::accumulate(_m.begin(), _m.end(), _i, std::plus<T>());
+        return std::accumulate(begin(), end(), _i, std::plus<T>());
     }
 
     T &local()
     {
-        return _m.at(threads::get_thread_num());
+        return _m.at(threads::get_thread_num()).value;
     }
     void reset()
     {
         for (auto &t : _m)
-            t = _i;
+            t.value = _i;
     }
     template <typename F>
     T combine_and_reset(F f) const
@@ -50,17 +131,16 @@ public:
     void init(const T &t = T())
     {
         _i = t;
-        _m.resize(threads::get_max_threads());
-        reset();
+        place([this](int) { return _i; });
     }
     void init(const std::vector<T> &v)
     {
         assert((int)v.size() == threads::get_max_threads());
-        _m.resize(threads::get_max_threads());
-        _m = v;
+        place([&v](int thread) { return v.at(thread); });
     }
 
-    typedef typename std::vector<T>::const_iterator const_iterator;
+    typedef slot_iterator<typename Slots::const_iterator, const T> const_iterator;
+    typedef slot_iterator<typename Slots::iterator, T> iterator;
 
     const_iterator begin() const
     {
@@ -72,7 +152,28 @@ public:
         return _m.end();
     }
 
+    iterator begin()
+    {
+        return _m.begin();
+    }
+
+    iterator end()
+    {
+        return _m.end();
+    }
+
+private:
+    // the element of each thread is made by that thread, see on_each_thread
+    // elements start empty, so that T allocates when the owner assigns it
+    template <typename F>
+    void place(F make)
+    {
+        Slots m(threads::get_max_threads());
+        threads::on_each_thread([&m, &make](int thread) { m[thread].value = make(thread); });
+        _m.swap(m);
+    }
+
 private:
-    std::vector<T> _m;
+    Slots _m;
     T _i;
-};
\ No newline at end of file
+};
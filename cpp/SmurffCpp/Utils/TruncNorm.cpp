@@ -5,6 +5,7 @@
 
 #include <cmath>
 
+#include <SmurffCpp/Utils/TruncNorm.h>
 #include <SmurffCpp/Utils/InvNormCdf.h>
 #include <SmurffCpp/Utils/Distribution.h>
 
@@ -43,3 +44,35 @@ double rand_truncnorm(double mean, double std, double low_cut) {
 	return std * xbar + mean;
 }
 
+
+// Phi(x) = erfc(-x / sqrt(2)) / 2, with the Chebyshev fit of erfc from
+// Numerical Recipes (erfcc). Both signs are computed without branches.
+smurff::Array1D approx_norm_cdf(const smurff::Array1D &x) {
+  typedef smurff::Array1D A;
+  const A z = x.abs() * M_SQRT1_2;
+  const A t = 1.0 / (1.0 + 0.5 * z);
+  const A p = -1.26551223 + t * (1.00002368 + t * (0.37409196 + t * (0.09678418 +
+              t * (-0.18628806 + t * (0.27886807 + t * (-1.13520398 + t * (1.48851587 +
+              t * (-0.82215223 + t * 0.17087277))))))));
+  const A tail = 0.5 * t * (p - z * z).exp(); // Phi(-|x|)
+  return (x < 0.0).select(tail, 1.0 - tail);
+}
+
+// X > a  <=>  -X < -a, so -X = inv_norm_cdf(u * Phi(-a)) with u ~ U(0, 1).
+// Sampling the lower tail keeps the precision when Phi(-a) is small.
+void rand_truncnorm(const smurff::Array1D &low_cut, smurff::Array1D &out) {
+  const int n = low_cut.size();
+  out.resize(n);
+  for (int i = 0; i < n; i++) {
+    out(i) = smurff::rand_unif();
+  }
+
+  out = -approx_inv_norm_cdf(out * approx_norm_cdf(-low_cut));
+
+  // same switch to rejection sampling as the scalar version
+  for (int i = 0; i < n; i++) {
+    if (low_cut(i) > 3.0) {
+      out(i) = rand_truncnorm_rej(low_cut(i));
+    }
+  }
+}
@@ -1,5 +1,13 @@
 #pragma once
 
+#include <SmurffCpp/Types.h>
+
 double norm_cdf(double x);
 double rand_truncnorm(double low_cut);
 double rand_truncnorm(double mean, double std, double low_cut);
+
+// vectorized approximation of norm_cdf, relative error < 1.2e-7
+smurff::Array1D approx_norm_cdf(const smurff::Array1D &x);
+
+// batched rand_truncnorm: out(i) is drawn from N(0, 1) truncated to out(i) > low_cut(i)
+void rand_truncnorm(const smurff::Array1D &low_cut, smurff::Array1D &out);
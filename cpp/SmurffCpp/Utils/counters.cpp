@@ -20,11 +20,44 @@
 
 static thread_vector<Counter *> active_counters(0);
 thread_vector<TotalsCounter> perf_data;
+static thread_vector<std::map<std::string, unsigned long long>> alloc_data;
+
+// heap allocations made by this thread while an AllocCounter is alive;
+// initial-exec TLS does not allocate on first use, so it is safe inside malloc
+static __thread unsigned long long thread_allocs __attribute__((tls_model("initial-exec"))) = 0;
+static __thread int alloc_depth __attribute__((tls_model("initial-exec"))) = 0;
+
+#ifdef __GLIBC__
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) noexcept
+{
+    if (alloc_depth) thread_allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) noexcept
+{
+    if (alloc_depth) thread_allocs++;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) noexcept
+{
+    if (alloc_depth) thread_allocs++;
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
 
 void perf_data_init()
 {
     active_counters.init();
     perf_data.init();
+    alloc_data.init();
 }
 
 void perf_data_print() {
@@ -33,6 +66,30 @@ void perf_data_print() {
     {
         p.print(threadid++);
     }
+
+#ifdef __GLIBC__
+    std::map<std::string, unsigned long long> allocs;
+    for(auto &a : alloc_data)
+        for(auto &p : a)
+            allocs[p.first] += p.second;
+
+    for(auto &p : allocs)
+        std::cout << ">> heap allocations in " << p.first << ":\t" << p.second << "\n";
+#endif
+}
+
+AllocCounter::AllocCounter(std::string name)
+    : name(name), start(thread_allocs)
+{
+    alloc_depth++;
+}
+
+AllocCounter::~AllocCounter()
+{
+    // nested counters on the same thread are counted by the outermost one
+    if (--alloc_depth) return;
+
+    alloc_data.local()[name] += thread_allocs - start;
 }
 
 Counter::Counter(std::string name)
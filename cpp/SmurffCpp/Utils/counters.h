@@ -51,12 +51,25 @@ struct TotalsCounter {
 
 extern thread_vector<TotalsCounter> perf_data;
 
+// counts the heap allocations of this thread while alive, reported by
+// perf_data_print; only on glibc, where malloc can be interposed
+#define ALLOC_COUNTER(name) AllocCounter ac(name)
+
+struct AllocCounter {
+    std::string name;
+    unsigned long long start;
+
+    AllocCounter(std::string name);
+    ~AllocCounter();
+};
+
 void perf_data_init();
 void perf_data_print();
 
 #else 
 
 #define COUNTER(name) 
+#define ALLOC_COUNTER(name)
 inline void perf_data_init() {}
 inline void perf_data_print() {}
 
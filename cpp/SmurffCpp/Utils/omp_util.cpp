@@ -30,6 +30,27 @@ namespace threads
         return omp_get_thread_num(); 
     }
 
+    bool in_parallel()
+    {
+        return omp_in_parallel();
+    }
+
+
+    void on_each_thread(const std::function<void(int)> &f)
+    {
+        const int n = get_max_threads();
+        if (omp_in_parallel())
+        {
+            for (int t = 0; t < n; t++)
+                f(t);
+            return;
+        }
+
+        // the team can be smaller than asked for
+        #pragma omp parallel num_threads(n)
+        for (int t = omp_get_thread_num(); t < n; t += omp_get_num_threads())
+            f(t);
+    }
 
     void init(int verbose, int num_threads) 
     {
@@ -62,9 +83,12 @@ namespace threads
 
     }
 
+    void on_each_thread(const std::function<void(int)> &f) { f(0); }
+
     int  get_num_threads() { return 1; }
     int  get_max_threads() { return 1; }
     int  get_thread_num() { return 0; } 
+    bool in_parallel() { return false; }
 
     #endif // _OPENMP
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 namespace threads
 {
 void init(int verbose, int num_threads);
@@ -8,4 +10,12 @@ int get_num_threads();
 int get_max_threads();
 int get_thread_num();
 
+// true inside a parallel region, where work is split in tasks instead of
+// starting a nested region
+bool in_parallel();
+
+// calls f(t) for t in [0, get_max_threads()) on the thread with number t of a
+// new parallel region; on the calling thread when already in a parallel region
+void on_each_thread(const std::function<void(int)> &f);
+
 } // namespace threads
@@ -1,6 +1,8 @@
 #include "MPIMacauPrior.h"
 
 #include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Utils/omp_util.h>
+#include <SmurffCpp/SideInfo/linop.h>
 
 namespace smurff {
 
@@ -22,6 +24,9 @@ void MPIMacauPrior::init()
    rhs_for_rank = new int[world_size];
    split_work_mpi(this->num_latent(), world_size, rhs_for_rank);
 
+   // each rank solves only its own right-hand sides
+   linop::tune_blockcg(rhs_for_rank[world_rank], threads::get_max_threads(), this->blockcg_blocksize, this->blockcg_excess);
+
    sendcounts = new int[world_size];
    displs = new int[world_size];
    int sum = 0;
@@ -69,8 +74,10 @@ void MPIMacauPrior::sample_beta()
          RHS(d, f) = rec[f + d * num_feat];
       }
    }
-   // solving
-   this->Features->solve_blockcg(result, this->beta_precision, RHS, this->tol, 32, 8);
+   // solving, ranks can be left without right-hand sides
+   if (nrhs > 0)
+      this->blockcg_iter = this->Features->solve_blockcg(result, this->beta_precision, RHS, this->tol, this->blockcg_blocksize, this->blockcg_excess,
+                                                        this->throw_on_cholesky_error, this->preconditioner);
    result.transposeInPlace();
    MPI_Gatherv(result.data(), nrhs*num_feat, MPI_DOUBLE, this->Ft_y.data(), sendcounts, displs, MPI_DOUBLE, 0, MPI_COMM_WORLD);
    if (world_rank == 0)
@@ -1,5 +1,8 @@
 #include "catch.hpp"
 
+#include <cmath>
+#include <tuple>
+
 #include <SmurffCpp/Types.h>
 
 #include <SmurffCpp/Utils/Error.h>
@@ -53,4 +56,46 @@ TEST_CASE( "CondNormalWishart" ) {
   auto p1 = CondNormalWishart(N, NS, NU, mean, kappa, T, nu);
 }
 
+TEST_CASE( "CondNormalWishartChol", "Test if the factored sampler draws what inverting X and factoring Lambda draws" ) {
+  Vector mean = matrix_utils::make_dense({1, 3} , { 1., 2., 3. });
+  Matrix T = Matrix::Identity(3,3);
+  double kappa = 2;
+  int nu = 4;
+  Matrix U(mu::make_dense({4, 3}, {1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 11., 12.}));
+  const int N = U.rows(), K = U.cols();
+
+  // reference: invert X, factor the scale and Lambda, same random numbers in the same order
+  init_bmrng(1234);
+  const int nu_c = nu + N;
+  const double kappa_c = kappa + N;
+  Vector mu_c = (kappa * mean + U.colwise().sum()) / kappa_c;
+  Matrix X = T + U.transpose() * U + kappa * mean.transpose() * mean - kappa_c * mu_c.transpose() * mu_c;
+  Matrix L = X.inverse().llt().matrixL();
+  Matrix c = Matrix::Zero(K, K);
+  for (int i = 0; i < K; i++)
+  {
+    c(i, i) = std::sqrt(2.0 * rand_gamma(0.5 * (nu_c - i)));
+    c.block(i, i + 1, 1, K - i - 1) = RandomVectorExpr(K - i - 1);
+  }
+  Matrix Lambda_ref = L * c.transpose() * c * L.transpose();
+  Matrix mu_ref = MvNormal(Lambda_ref * kappa_c, mu_c);
+
+  init_bmrng(1234);
+  Vector mu_o;
+  Matrix Lambda, Lambda_L;
+  std::tie(mu_o, Lambda, Lambda_L) = CondNormalWishartChol(U, mean, kappa, T, nu);
+
+  REQUIRE(mu::equals(Lambda, Lambda_ref, 1e-6));
+  REQUIRE(mu::equals_vector(mu_o, mu_ref, 1e-6));
+  REQUIRE(mu::equals(Lambda_L * Lambda_L.transpose(), Lambda, 1e-6));
+  REQUIRE(Lambda_L.triangularView<Eigen::StrictlyUpper>().toDenseMatrix().isZero());
+
+  // the factor gives the same draws as factoring Lambda again
+  init_bmrng(42);
+  Matrix r1 = MvNormal(Lambda, 5);
+  init_bmrng(42);
+  Matrix r2 = MvNormalChol(Lambda_L, 5);
+  REQUIRE(mu::equals(r1, r2, 1e-6));
+}
+
 }
\ No newline at end of file
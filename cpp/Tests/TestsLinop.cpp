@@ -2,6 +2,7 @@
 
 #include <SmurffCpp/Utils/Error.h>
 #include <SmurffCpp/SideInfo/linop.h>
+#include <SmurffCpp/SideInfo/DenseSideInfo.h>
 #include <SmurffCpp/Utils/Distribution.h>
 
 namespace smurff {
@@ -57,6 +58,169 @@ TEST_CASE( "SparseSideInfo/solve_blockcg_1_0", "BlockCG solver (3rhs separately)
 }
 
 
+TEST_CASE( "SparseSideInfo/solve_blockcg_preconditioned", "Preconditioned BlockCG solver (3rhs)" ) 
+{
+   SparseSideInfo sf(DataConfig(binarySideInfo, false, fixed_ncfg));
+   Matrix B(3, 4), X_true(3, 4);
+ 
+   B << 0.56,  0.55,  0.3 , -1.78,
+        0.34,  0.05, -1.48,  1.11,
+        0.09,  0.51, -0.63,  1.59;
+   B.transposeInPlace();
+ 
+   X_true << 0.35555556,  0.40709677, -0.16444444, -0.87483871,
+             1.69333333, -0.12709677, -1.94666667,  0.49483871,
+             0.66      , -0.04064516, -0.78      ,  0.65225806;
+   X_true.transposeInPlace();
+
+   for (auto type : { PreconditionerTypes::jacobi, PreconditionerTypes::block_jacobi })
+   {
+      Matrix X(4, 3);
+      linop::Preconditioner precond(type, sf);
+      precond.compute(0.5);
+      int niter = linop::solve_blockcg_1block(X, sf, 0.5, B, 1e-6, false, &precond);
+
+      // the block is the whole of K' * K here, so block_jacobi solves it at once
+      if (type == PreconditionerTypes::block_jacobi)
+         REQUIRE( niter == 1 );
+
+      for (int i = 0; i < X.rows(); i++) {
+        for (int j = 0; j < X.cols(); j++) {
+          REQUIRE( X(i,j) == Approx(X_true(i,j)) );
+        }
+      }
+
+      // through the side info, which keeps the preconditioner
+      X.setZero();
+      sf.solve_blockcg(X, 0.5, B, 1e-6, 1, 0, false, type);
+      for (int i = 0; i < X.rows(); i++) {
+        for (int j = 0; j < X.cols(); j++) {
+          REQUIRE( X(i,j) == Approx(X_true(i,j)) );
+        }
+      }
+   }
+}
+
+
+TEST_CASE( "SparseSideInfo/solve_blockcg_warm_start", "BlockCG solver from an initial guess" ) 
+{
+   SparseSideInfo sf(DataConfig(binarySideInfo, false, fixed_ncfg));
+   Matrix B(3, 4), X_true(3, 4);
+ 
+   B << 0.56,  0.55,  0.3 , -1.78,
+        0.34,  0.05, -1.48,  1.11,
+        0.09,  0.51, -0.63,  1.59;
+   B.transposeInPlace();
+ 
+   X_true << 0.35555556,  0.40709677, -0.16444444, -0.87483871,
+             1.69333333, -0.12709677, -1.94666667,  0.49483871,
+             0.66      , -0.04064516, -0.78      ,  0.65225806;
+   X_true.transposeInPlace();
+
+   // the solution itself needs no iterations
+   Matrix X = X_true;
+   int niter = linop::solve_blockcg_1block(X, sf, 0.5, B, 1e-6, false, nullptr, true);
+   REQUIRE( niter == 0 );
+
+   // a guess close by, and one far off in the last column that is not used
+   Matrix X_guess = X_true;
+   X_guess.col(0).array() += 0.01;
+   X_guess.col(2).array() += 100.0;
+   for (auto precond : { PreconditionerTypes::none, PreconditionerTypes::jacobi })
+   {
+      X = X_guess;
+      sf.solve_blockcg(X, 0.5, B, 1e-6, 1, 0, false, precond, true);
+      for (int i = 0; i < X.rows(); i++) {
+        for (int j = 0; j < X.cols(); j++) {
+          REQUIRE( X(i,j) == Approx(X_true(i,j)) );
+        }
+      }
+   }
+}
+
+
+TEST_CASE( "linop/spmm", "Parallel sparse times dense products" )
+{
+   SparseSideInfo sf(DataConfig(binarySideInfo, false, fixed_ncfg));
+   const Matrix F = Matrix(binarySideInfo);
+   const Matrix B = Matrix::Random(4, 3);
+   const Matrix AtA_B = F.transpose() * (F * B) + 0.5 * B;
+
+   Matrix out, tmp;
+   linop::spmm(out, binarySideInfo, B);
+   REQUIRE( matrix_utils::equals(out, F * B, 1e-6) );
+
+   sf.AtA_mul_B(out, 0.5, B, tmp);
+   REQUIRE( matrix_utils::equals(out, AtA_B, 1e-6) );
+
+   // as tasks, the way update_prior calls it
+   Matrix out_tasks;
+   #pragma omp parallel
+   #pragma omp master
+   linop::AtA_mul_B(out_tasks, sf, 0.5, B, tmp);
+   REQUIRE( matrix_utils::equals(out_tasks, AtA_B, 1e-6) );
+
+   DenseSideInfo df(DataConfig(F, fixed_ncfg));
+   df.AtA_mul_B(out, 0.5, B, tmp);
+   REQUIRE( matrix_utils::equals(out, AtA_B, 1e-6) );
+}
+
+
+TEST_CASE( "linop/tune_blockcg", "Blocksize and excess of the block CG" )
+{
+   int blocksize, excess;
+
+   // the old defaults on one thread
+   linop::tune_blockcg(128, 1, blocksize, excess);
+   REQUIRE( blocksize == 32 );
+   REQUIRE( excess == 8 );
+
+   // smaller blocks to use more threads
+   linop::tune_blockcg(128, 64, blocksize, excess);
+   REQUIRE( blocksize == 16 );
+   REQUIRE( excess == 4 );
+
+   linop::tune_blockcg(10, 64, blocksize, excess);
+   REQUIRE( blocksize == 10 );
+
+   // no right-hand sides
+   linop::tune_blockcg(0, 64, blocksize, excess);
+   REQUIRE( blocksize == 1 );
+   REQUIRE( excess == 0 );
+}
+
+TEST_CASE( "SparseSideInfo/solve_blockcg_concurrent", "BlockCG solver, blocks as tasks" ) 
+{
+   SparseSideInfo sf(DataConfig(binarySideInfo, false, fixed_ncfg));
+   Matrix B(3, 4), X_true(3, 4);
+ 
+   B << 0.56,  0.55,  0.3 , -1.78,
+        0.34,  0.05, -1.48,  1.11,
+        0.09,  0.51, -0.63,  1.59;
+   B.transposeInPlace();
+ 
+   X_true << 0.35555556,  0.40709677, -0.16444444, -0.87483871,
+             1.69333333, -0.12709677, -1.94666667,  0.49483871,
+             0.66      , -0.04064516, -0.78      ,  0.65225806;
+   X_true.transposeInPlace();
+
+   // blocks of 2 + 1 and 1 + 1 + 1, inside a parallel region like update_prior
+   for (int blocksize : { 1, 2 })
+   {
+      Matrix X(4, 3);
+      #pragma omp parallel
+      #pragma omp master
+      linop::solve_blockcg(X, sf, 0.5, B, 1e-6, blocksize, 0, false, nullptr);
+
+      for (int i = 0; i < X.rows(); i++) {
+        for (int j = 0; j < X.cols(); j++) {
+          REQUIRE( X(i,j) == Approx(X_true(i,j)) );
+        }
+      }
+   }
+}
+
+
 TEST_CASE( "Eigen::MatrixFree::1", "Test linop::AtA_mulB - 1" )
 {
   SparseSideInfo sf(DataConfig(binarySideInfo, false, fixed_ncfg));
@@ -125,6 +125,12 @@ struct SmurffTest {
     return *this;
   }
 
+  // direct solver on a sparse F'F
+  SmurffTest &addSparseDirectSideInfo(int m, const SparseMatrix &c) {
+    config.addSideInfo(m, makeSideInfoConfig(c, true)).setSparseDirect(true);
+    return *this;
+  }
+
   SmurffTest &addAuxData(const DataConfig &c) {
     config.addData() = c;
     return *this;
@@ -254,6 +260,16 @@ TEST_CASE("train_dense_matrix_test_sparse_matrix_macau_macau_row_side_info_dense
       .runAndCheck(1018);
 }
 
+// same side info as above, as sparse matrices with a sparse direct solver
+TEST_CASE("train_dense_matrix_test_sparse_matrix_macau_macau_row_side_info_sparse_matrix_col_side_info_sparse_matrix_sparse_direct",
+          TAG_MATRIX_TESTS) {
+
+  SmurffTest(trainDenseMatrix, testSparseMatrix, {PriorTypes::macau, PriorTypes::macau})
+      .addSparseDirectSideInfo(0, rowSideSparseMatrix)
+      .addSparseDirectSideInfo(1, colSideSparseMatrix)
+      .runAndCheck(1018);
+}
+
 TEST_CASE("train_sparse_matrix_test_sparse_matrix_macau_macau_row_side_info_dense_matrix_col_side_info_dense_matrix_",
           TAG_MATRIX_TESTS) {
 
@@ -9,7 +9,11 @@
 
 #include <SmurffCpp/Utils/MatrixUtils.h>
 #include <SmurffCpp/DataTensors/SparseMode.h>
+#include <SmurffCpp/DataTensors/TensorStore.h>
 #include <SmurffCpp/DataTensors/TensorData.h>
+#include <SmurffCpp/Noises/NoiseFactory.h>
+#include <SmurffCpp/Utils/Distribution.h>
+#include <SmurffCpp/Model.h>
 
 namespace smurff {
 
@@ -121,6 +125,187 @@ TEST_CASE("test sparse view new 2")
    */
 }
 
+TEST_CASE("TensorStore/modes", "Test if all modes see the items of the shared store, with 16 bit coordinates for small modes")
+{
+   std::vector<std::uint64_t> dims = { 3, 70000, 4 };
+   std::vector<std::vector<std::uint32_t>> columns =
+      {
+         { 2, 0, 1, 0, 2, 1 },
+         { 5, 69999, 0, 12, 5, 40000 },
+         { 3, 0, 1, 2, 0, 3 },
+      };
+   std::vector<double> values = { 1., -2., 0.5, 3., 1.5, -1. };
+
+   TensorData td(SparseTensor(dims, columns, values));
+   const TensorStore &store = td.Y(0)->getStore();
+
+   REQUIRE(store.isNarrow(0));
+   REQUIRE(!store.isNarrow(1));
+   REQUIRE(store.isNarrow(2));
+   REQUIRE(store.memory() == values.size() * (2 + 4 + 2 + sizeof(double)));
+
+   for (std::uint32_t mode = 0; mode < 3; mode++)
+   {
+      std::shared_ptr<SparseMode> sview = td.Y(mode);
+      REQUIRE(&sview->getStore() == &store);
+
+      std::uint64_t count = 0;
+      for (std::uint64_t h = 0; h < sview->getNPlanes(); h++)
+      {
+         for (std::uint64_t n = 0; n < sview->nItemsOnPlane(h); n++, count++)
+         {
+            auto item = sview->item(h, n);
+            REQUIRE(item.first.at(mode) == (int)h);
+
+            // find the item in the input
+            std::size_t i = 0;
+            while (i < values.size() && !(item.first == PVec<>({ (int)columns[0][i], (int)columns[1][i], (int)columns[2][i] })))
+               i++;
+            REQUIRE(i < values.size());
+            REQUIRE(item.second == values[i]);
+         }
+      }
+      REQUIRE(count == values.size());
+   }
+}
+
+TEST_CASE("TensorData/getMuLambda", "Test if the Khatri-Rao kernel gives the same rr and MM as per-item products")
+{
+   // plane 0 of mode 0 is fully observed and spans two panels
+   std::vector<std::uint64_t> dims = { 2, 20, 15 };
+   std::vector<std::vector<std::uint32_t>> columns(3);
+   std::vector<double> values;
+   for (std::uint32_t i = 0; i < 20; i++)
+      for (std::uint32_t j = 0; j < 15; j++)
+         for (std::uint32_t p = 0; p < 2; p++)
+         {
+            if (p == 1 && (i + j) % 7) continue;
+            columns[0].push_back(p);
+            columns[1].push_back(i);
+            columns[2].push_back(j);
+            values.push_back(0.1 * i - 0.2 * j + p);
+         }
+
+   SparseTensor tensor(dims, columns, values);
+   TensorData td(tensor);
+   td.setNoiseModel(NoiseFactory::create_noise_model(NoiseConfig(NoiseTypes::fixed)));
+   td.init();
+
+   init_bmrng(1234);
+   Model model;
+   model.init(3, PVec<>({ 2, 20, 15 }), ModelInitTypes::random, false);
+   const double alpha = td.noise().getAlpha();
+
+   for (std::uint32_t mode = 0; mode < 3; mode++)
+   {
+      std::shared_ptr<SparseMode> sview = td.Y(mode);
+      for (std::uint64_t d = 0; d < sview->getNPlanes(); d++)
+      {
+         Vector rr = Vector::Zero(3);
+         Matrix MM = Matrix::Zero(3, 3);
+         td.getMuLambda(model.full(), mode, d, rr, MM);
+
+         Vector rr_true = Vector::Zero(3);
+         Matrix MM_true = Matrix::Zero(3, 3);
+         for (std::uint64_t n = 0; n < sview->nItemsOnPlane(d); n++)
+         {
+            auto item = sview->item(d, n);
+            Vector row = Vector::Ones(3);
+            for (std::uint32_t m = 0; m < 3; m++)
+               if (m != mode)
+                  row = row.cwiseProduct(model.U(m).row(item.first.at(m)));
+            rr_true += alpha * item.second * row;
+            MM_true += alpha * row.transpose() * row;
+         }
+
+         for (int i = 0; i < 3; i++)
+         {
+            REQUIRE(rr(i) == Approx(rr_true(i)));
+            for (int j = 0; j < 3; j++)
+               REQUIRE(MM(i, j) == Approx(MM_true(i, j)));
+         }
+      }
+   }
+}
+
+TEST_CASE("TensorData/sumsq_row", "Test if the hyperplane residuals of each mode add up to sumsq")
+{
+   std::vector<std::uint64_t> dims = { 2, 3, 4 };
+   std::vector<std::vector<std::uint32_t>> columns =
+      {
+         { 0, 1, 0, 1, 0, 1, 1 },
+         { 0, 0, 1, 2, 2, 1, 0 },
+         { 0, 1, 3, 2, 0, 3, 3 },
+      };
+   std::vector<double> values = { 1., -2., 0.5, 3., 1.5, -1., 2. };
+
+   TensorData td(SparseTensor(dims, columns, values));
+   td.setNoiseModel(NoiseFactory::create_noise_model(NoiseConfig(NoiseTypes::fixed)));
+   td.init();
+
+   init_bmrng(1234);
+   Model model;
+   model.init(3, PVec<>({ 2, 3, 4 }), ModelInitTypes::random, false);
+
+   for (std::uint32_t mode = 0; mode < 3; mode++)
+   {
+      double sumsq = 0.0;
+      for (std::uint64_t d = 0; d < dims[mode]; d++)
+         sumsq += td.sumsq_row(model.full(), mode, d);
+
+      REQUIRE(sumsq == Approx(td.sumsq(model.full())));
+   }
+}
+
+TEST_CASE("TensorData/binary", "Test if binary tensor data gives the same results as a tensor of ones")
+{
+   std::vector<std::uint64_t> dims = { 2, 3, 4 };
+   std::vector<std::vector<std::uint32_t>> columns =
+      {
+         { 0, 1, 0, 1, 0, 1, 1 },
+         { 0, 0, 1, 2, 2, 1, 0 },
+         { 0, 1, 3, 2, 0, 3, 3 },
+      };
+   std::vector<double> values = { 1., -2., 0.5, 3., 1.5, -1., 2. };
+
+   TensorData binary(SparseTensor(dims, columns, values), true); // values are ignored
+   TensorData ones(SparseTensor(dims, columns, std::vector<double>(values.size(), 1.)));
+
+   init_bmrng(1234);
+   Model model;
+   model.init(3, PVec<>({ 2, 3, 4 }), ModelInitTypes::random, false);
+
+   for (auto td : { &binary, &ones })
+   {
+      td->setNoiseModel(NoiseFactory::create_noise_model(NoiseConfig(NoiseTypes::fixed)));
+      td->init();
+   }
+
+   REQUIRE(binary.Y(0)->getStore().memory() < ones.Y(0)->getStore().memory());
+   REQUIRE(binary.sum() == Approx(ones.sum()));
+   REQUIRE(binary.sumsq(model.full()) == Approx(ones.sumsq(model.full())));
+
+   for (std::uint32_t mode = 0; mode < 3; mode++)
+   {
+      for (std::uint64_t d = 0; d < dims[mode]; d++)
+      {
+         Vector rr = Vector::Zero(3), rr_true = Vector::Zero(3);
+         Matrix MM = Matrix::Zero(3, 3), MM_true = Matrix::Zero(3, 3);
+         binary.getMuLambda(model.full(), mode, d, rr, MM);
+         ones.getMuLambda(model.full(), mode, d, rr_true, MM_true);
+
+         for (int i = 0; i < 3; i++)
+         {
+            REQUIRE(rr(i) == Approx(rr_true(i)));
+            for (int j = 0; j < 3; j++)
+               REQUIRE(MM(i, j) == Approx(MM_true(i, j)));
+         }
+
+         REQUIRE(binary.sumsq_row(model.full(), mode, d) == Approx(ones.sumsq_row(model.full(), mode, d)));
+      }
+   }
+}
+
 //smurff
 
 /*
@@ -6,18 +6,24 @@
 #include <iostream>
 #include <sstream>
 #include <vector>
+#include <numeric>
 #include <limits>
 
 #include <boost/version.hpp>
 
 #include <SmurffCpp/result.h>
+#include <SmurffCpp/Aggregate.h>
 
 #include <SmurffCpp/Utils/TruncNorm.h>
 #include <SmurffCpp/Utils/InvNormCdf.h>
 #include <SmurffCpp/Utils/Distribution.h>
 #include <SmurffCpp/Utils/counters.h>
 #include <SmurffCpp/Utils/MatrixUtils.h>
+#include <SmurffCpp/Utils/ScratchArena.h>
+#include <SmurffCpp/Utils/ThreadVector.hpp>
+#include <SmurffCpp/Utils/omp_util.h>
 
+#include <SmurffCpp/Configs/Config.h>
 #include <SmurffCpp/Configs/DataConfig.h>
 
 #include <SmurffCpp/Priors/ILatentPrior.h>
@@ -31,9 +37,13 @@
 #include <SmurffCpp/DataMatrices/FullMatrixData.hpp>
 #include <SmurffCpp/DataMatrices/SparseMatrixData.h>
 #include <SmurffCpp/DataMatrices/DenseMatrixData.h>
+#include <SmurffCpp/DataMatrices/BinaryMatrixData.h>
+#include <SmurffCpp/DataMatrices/DualSparseMatrix.h>
 
 #include <SmurffCpp/SideInfo/DenseSideInfo.h>
 
+#include <SmurffCpp/Sessions/TrainSession.h>
+
 namespace smurff {
 
 
@@ -62,6 +72,413 @@ TEST_CASE( "latentprior/sample_beta_precision", "sampling beta precision from ga
   REQUIRE( beta_precision > 0 );
 }
 
+TEST_CASE( "latentprior/sample_posterior", "Test if the fixed-size kernels draw the same sample as the dynamic one") {
+  const int K = 32;
+  Matrix A = Matrix::Random(K, K);
+  const Matrix MM = A * A.transpose() + K * Matrix::Identity(K, K);
+  const Matrix Lambda = 2.0 * Matrix::Identity(K, K);
+  const Vector rr = Vector::Random(K);
+  const Vector mu = Vector::Random(K);
+  const Vector rr_mu = rr + mu * Lambda;
+
+  Vector u_fixed(K), u_dynamic(K);
+
+  init_bmrng(1234);
+  NormalPrior::sample_posterior<K>(rr_mu, MM, Eigen::Map<const Matrix>(Lambda.data(), K, K), u_fixed);
+
+  init_bmrng(1234);
+  Vector rr_dynamic = rr_mu;
+  Matrix MM_dynamic = MM;
+  NormalPrior::sample_posterior_inplace(rr_dynamic, MM_dynamic, Eigen::Map<const Matrix>(Lambda.data(), K, K), u_dynamic);
+
+  for (int i = 0; i < K; i++)
+    REQUIRE(u_fixed(i) == Approx(u_dynamic(i)));
+
+  // the mean of many samples is the posterior mean
+  init_bmrng(1234);
+  const Vector mean_true = (rr + mu * Lambda) * (MM + Lambda).inverse();
+  Vector mean = Vector::Zero(K);
+  const int nsamples = 10000;
+  for (int s = 0; s < nsamples; s++)
+  {
+    NormalPrior::sample_posterior<K>(rr_mu, MM, Eigen::Map<const Matrix>(Lambda.data(), K, K), u_fixed);
+    mean += u_fixed / nsamples;
+  }
+
+  for (int i = 0; i < K; i++)
+    REQUIRE(mean(i) == Approx(mean_true(i)).margin(0.01));
+
+  // without data the sample is mu + L^-T * z, with L the Cholesky factor of Lambda, as in sample_prior
+  const Matrix L = Lambda.llt().matrixL();
+  init_bmrng(1234);
+  NormalPrior::sample_posterior<K>(mu * Lambda, Matrix::Zero(K, K), Eigen::Map<const Matrix>(Lambda.data(), K, K), u_fixed);
+  init_bmrng(1234);
+  Vector u_prior = Vector::NullaryExpr(K, RandNormalGenerator());
+  L.triangularView<Eigen::Lower>().transpose().solveInPlace(u_prior.transpose());
+  u_prior += mu;
+  for (int i = 0; i < K; i++)
+    REQUIRE(u_fixed(i) == Approx(u_prior(i)));
+}
+
+TEST_CASE( "latentprior/sample_posterior_batch", "Test if the interleaved kernel draws the same samples as the per-row one from the same systems, which holds for whole sessions only with Gaussian noise") {
+  const int K = 6;
+  const int nrows = 5;
+  const int B = NormalPrior::batch_rows;
+  const Matrix Lambda = 2.0 * Matrix::Identity(K, K);
+  const Eigen::Map<const Matrix> Lambda_u(Lambda.data(), K, K);
+
+  std::vector<Vector> rrs, mus;
+  std::vector<Matrix> MMs;
+  std::vector<float_type> A(K * K * B), x(K * B);
+  for (int l = 0; l < nrows; l++)
+  {
+    Matrix R = Matrix::Random(K, K);
+    MMs.push_back(R * R.transpose() + Matrix::Identity(K, K));
+    rrs.push_back(Vector::Random(K));
+    mus.push_back(Vector::Random(K));
+
+    const Matrix M = MMs[l] + Lambda;
+    const Vector r = rrs[l] + mus[l] * Lambda;
+    for (int i = 0; i < K; i++)
+    {
+      for (int j = 0; j <= i; j++)
+        A[(i * K + j) * B + l] = M(i, j);
+      x[i * B + l] = r(i);
+    }
+  }
+
+  init_bmrng(1234);
+  NormalPrior::sample_posterior_batch(K, nrows, A.data(), x.data());
+
+  init_bmrng(1234);
+  for (int l = 0; l < nrows; l++)
+  {
+    Vector u(K);
+    Vector rr = rrs[l] + mus[l] * Lambda;
+    NormalPrior::sample_posterior_inplace(rr, MMs[l], Lambda_u, u);
+    for (int i = 0; i < K; i++)
+      REQUIRE(x[i * B + l] == Approx(u(i)));
+  }
+}
+
+// gives access to the priors of a session
+struct PriorsSession : public TrainSession
+{
+  PriorsSession(const Config &c) : TrainSession(c) {}
+  NormalPrior &prior(int mode) { return dynamic_cast<NormalPrior &>(*m_priors.at(mode)); }
+};
+
+TEST_CASE( "latentprior/sample_latent_full_empty_row", "Test if an empty row of fully known sparse data is sampled from the posterior, not from the prior") {
+  // row 1 stores nothing, but its zeros are known
+  const SparseMatrix Y = matrix_utils::make_sparse({3, 4}, {{0, 0, 2, 2}, {0, 3, 1, 2}}, {1., 2., 3., 4.});
+  const int n = 1;
+
+  Config config;
+  config.setPriorTypes({PriorTypes::normal, PriorTypes::normal});
+  config.setBurnin(1);
+  config.setNSamples(1);
+  config.setVerbose(0);
+  config.setRandomSeed(1234);
+  config.setNumLatent(4);
+  config.setModelInitType(ModelInitTypes::random);
+  config.getTrain().setData(Y, false);
+  config.getTrain().setNoiseConfig(fixed_ncfg);
+  config.getTest().setData(Y);
+
+  PriorsSession session(config);
+  session.init();
+  NormalPrior &prior = session.prior(0);
+
+  REQUIRE(session.data().row_nnz(0, n) == 0);
+  REQUIRE(session.data().row_nobs(0, n) == 4);
+  REQUIRE(!prior.samplePriorOnly(n));
+
+  // the general path, with V'V of the known zeros in MM
+  session.data().update_pnm(session.model(), 0);
+  Vector rr = Vector::Zero(4);
+  Matrix MM = Matrix::Zero(4, 4);
+  session.data().getMuLambda(session.model(), 0, n, rr, MM);
+  prior.addMuLambda(n, rr);
+  REQUIRE(MM.norm() > 0);
+
+  Vector expected(4);
+  init_bmrng(1234);
+  NormalPrior::sample_posterior_inplace(rr, MM, prior.getLambda(n), expected);
+
+  init_bmrng(1234);
+  prior.sample_latent(n);
+  for (int i = 0; i < 4; i++)
+    REQUIRE(prior.U()(n, i) == Approx(expected(i)));
+}
+
+TEST_CASE( "latentprior/make_chunks", "Test if rows are split in chunks of equal cost with heavy rows on their own") {
+  std::vector<std::uint64_t> row_cost(1000, 3);
+  row_cost[500] = 10000;
+  const std::uint64_t chunk_cost = (999 * 3 + 10000) / 10;
+
+  auto chunks = ILatentPrior::make_chunks(row_cost, 10);
+  REQUIRE(chunks.front() == 0);
+  REQUIRE(chunks.back() == 1000);
+
+  bool heavy_alone = false;
+  for (std::size_t c = 0; c + 1 < chunks.size(); c++)
+  {
+    REQUIRE(chunks[c] < chunks[c + 1]);
+    if (chunks[c] == 500)
+    {
+      heavy_alone = chunks[c + 1] == 501;
+      continue;
+    }
+
+    std::uint64_t cost = std::accumulate(row_cost.begin() + chunks[c], row_cost.begin() + chunks[c + 1], (std::uint64_t)0);
+    REQUIRE(cost < chunk_cost + 3);
+    if (chunks[c + 1] != 500 && c + 2 < chunks.size())
+      REQUIRE(cost >= chunk_cost);
+  }
+  REQUIRE(heavy_alone);
+
+  // one chunk when asked for one
+  chunks = ILatentPrior::make_chunks(std::vector<std::uint64_t>(10, 1), 1);
+  REQUIRE(chunks == std::vector<int>({0, 10}));
+}
+
+TEST_CASE( "utils/thread_vector", "Test if every thread has its own cache line and init places every element") {
+  thread_vector<double> tv(1.0);
+  REQUIRE(tv.combine() == Approx(1.0 + threads::get_max_threads()));
+
+  std::vector<std::uintptr_t> addr;
+  for (auto &v : tv)
+    addr.push_back(reinterpret_cast<std::uintptr_t>(&v));
+  REQUIRE((int)addr.size() == threads::get_max_threads());
+  for (std::size_t i = 0; i < addr.size(); i++)
+  {
+    REQUIRE(addr[i] % threads::cache_line_size == 0);
+    if (i > 0)
+      REQUIRE(addr[i] - addr[i - 1] >= threads::cache_line_size);
+  }
+
+  thread_vector<Vector> tv2;
+  tv2.init(Vector::Zero(3));
+  int team = 0;
+  #pragma omp parallel reduction(+:team)
+  {
+    tv2.local() += Vector::Ones(3);
+    team++;
+  }
+  REQUIRE(tv2.combine() == Vector::Constant(3, team));
+}
+
+// not run by default, run with: tests "[benchmark]"
+// compares per-thread data in a plain std::vector, first touched by the main
+// thread, with thread_vector; the difference shows on multi-socket machines
+TEST_CASE( "utils/thread_vector benchmark", "[.][benchmark]") {
+  const int nthreads = threads::get_max_threads();
+  const int nincr = 20000000;
+  const int nelem = 1 << 22;
+  const int nsum = 20;
+
+  // false sharing: every thread increments its own counter
+  std::vector<double> plain(nthreads, 0.0);
+  thread_vector<double> padded(0.0);
+
+  double start = tick();
+  #pragma omp parallel
+  {
+    volatile double *x = &plain[threads::get_thread_num()];
+    for (int i = 0; i < nincr; i++) *x = *x + 1.0;
+  }
+  const double t_plain = tick() - start;
+
+  start = tick();
+  #pragma omp parallel
+  {
+    volatile double *x = &padded.local();
+    for (int i = 0; i < nincr; i++) *x = *x + 1.0;
+  }
+  const double t_padded = tick() - start;
+
+  // NUMA placement: every thread streams through its own vector
+  std::vector<Vector> serial(nthreads, Vector::Ones(nelem));
+  thread_vector<Vector> placed;
+  placed.init(Vector::Ones(nelem));
+
+  thread_vector<double> sums(0.0);
+  start = tick();
+  #pragma omp parallel
+  for (int i = 0; i < nsum; i++) sums.local() += serial[threads::get_thread_num()].sum();
+  const double t_serial = tick() - start;
+
+  start = tick();
+  #pragma omp parallel
+  for (int i = 0; i < nsum; i++) sums.local() += placed.local().sum();
+  const double t_placed = tick() - start;
+
+  std::cout << "thread_vector benchmark with " << nthreads << " threads\n"
+            << "  counters, std::vector:    " << t_plain << " s\n"
+            << "  counters, thread_vector:  " << t_padded << " s\n"
+            << "  streaming, main thread first touch:  " << t_serial << " s\n"
+            << "  streaming, thread_vector::init:      " << t_placed << " s\n";
+
+  REQUIRE(padded.combine() == Approx(std::accumulate(plain.begin(), plain.end(), 0.0)));
+  REQUIRE(sums.combine() > 0.0);
+}
+
+TEST_CASE( "utils/ScratchArena", "Test if frames give back their memory and the arena grows to the peak use") {
+  ScratchArena arena(4 * 64);
+  REQUIRE(arena.capacity() >= 4 * 64);
+
+  {
+    ScratchArena::Frame outer(arena);
+    auto v = arena.vector(3);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(v.data()) % ScratchArena::alignment == 0);
+    v << 1., 2., 3.;
+    const std::size_t used = arena.used();
+
+    {
+      ScratchArena::Frame inner(arena);
+      auto m = arena.matrix(2, 2);
+      m.setConstant(-1.);
+      REQUIRE(m.data() != v.data());
+      REQUIRE(arena.overflows() == 0);
+    }
+    REQUIRE(arena.used() == used);
+
+    // does not fit, goes to the heap
+    auto big = arena.vector(100);
+    big.setZero();
+    REQUIRE(arena.overflows() == 1);
+    REQUIRE(v.sum() == Approx(6.));
+  }
+  REQUIRE(arena.used() == 0);
+
+  // the first allocation after the next reset makes room for the peak use
+  const std::size_t capacity = arena.capacity();
+  arena.reset();
+  REQUIRE(arena.capacity() == capacity);
+  {
+    ScratchArena::Frame frame(arena);
+    arena.vector(3);
+    REQUIRE(arena.capacity() >= ScratchArena::footprint<float_type>(3) + ScratchArena::footprint<float_type>(100));
+    arena.vector(100);
+  }
+  REQUIRE(arena.overflows() == 1);
+}
+
+TEST_CASE( "Model/Aggregate", "Test if packed, diagonal and spilled aggregates give the posterior of the full outer products") {
+  const int nrows = 7, K = 4, nsamples = 5;
+  const int singular_row = 5;
+
+  // latent 1 of singular_row does not change, its covariance is singular
+  std::vector<Matrix> samples;
+  for (int s = 0; s < nsamples; s++)
+  {
+    samples.push_back(Matrix::Random(nrows, K));
+    samples.back()(singular_row, 1) = 0.5;
+  }
+
+  Aggregate packed(AggregateTypes::packed, nrows, K);
+  Aggregate diagonal(AggregateTypes::diagonal, nrows, K);
+  Aggregate spill(AggregateTypes::spill, nrows, K, "test_aggregate.spill");
+  for (const auto &U : samples)
+  {
+    packed.add(U);
+    diagonal.add(U);
+    spill.add(U);
+  }
+  REQUIRE(packed.num() == nsamples);
+  REQUIRE(Aggregate::dot_cols(AggregateTypes::packed, K) == K * (K + 1) / 2);
+
+  Matrix mu_p(nrows, K), Lambda_p(nrows, K * (K + 1) / 2);
+  Matrix mu_d(nrows, K), Lambda_d(nrows, K);
+  Matrix mu_s(nrows, K), Lambda_s(nrows, K * (K + 1) / 2);
+  int first_p, first_d, first_s;
+  REQUIRE(packed.post(0, mu_p, Lambda_p, first_p) == 1);
+  REQUIRE(diagonal.post(0, mu_d, Lambda_d, first_d) == 1);
+  REQUIRE(spill.post(0, mu_s, Lambda_s, first_s) == 1);
+  REQUIRE((first_p == singular_row && first_d == singular_row && first_s == singular_row));
+
+  // no NaNs for the singular row
+  REQUIRE(Lambda_p.row(singular_row).isZero());
+  REQUIRE(Lambda_d.row(singular_row).isZero());
+  REQUIRE(Lambda_s.row(singular_row).isZero());
+
+  for (int i = 0; i < nrows; i++)
+  {
+    if (i == singular_row)
+      continue;
+
+    Vector sum = Vector::Zero(K);
+    Matrix prod = Matrix::Zero(K, K);
+    for (const auto &U : samples)
+    {
+      sum += U.row(i);
+      prod += U.row(i).transpose() * U.row(i);
+    }
+    Matrix cov = (prod - sum.transpose() * sum / nsamples) / (nsamples - 1);
+    Matrix prec = cov.inverse();
+
+    REQUIRE(matrix_utils::equals_vector(mu_p.row(i), sum / nsamples, 1e-6));
+    REQUIRE(matrix_utils::equals_vector(mu_d.row(i), sum / nsamples, 1e-6));
+    for (int c = 0; c < K; c++)
+    {
+      REQUIRE(Lambda_d(i, c) == Approx(1. / cov(c, c)).epsilon(1e-6));
+      for (int j = 0; j <= c; j++)
+      {
+        REQUIRE(Lambda_p(i, c * (c + 1) / 2 + j) == Approx(prec(c, j)).epsilon(1e-6).margin(1e-6));
+        REQUIRE(Lambda_s(i, c * (c + 1) / 2 + j) == Approx(prec(c, j)).epsilon(1e-6).margin(1e-6));
+      }
+    }
+  }
+
+  // post_lambda is saved as full K x K precisions
+  Matrix full_p, full_d;
+  Aggregate::full_lambda(AggregateTypes::packed, K, Lambda_p, full_p);
+  Aggregate::full_lambda(AggregateTypes::diagonal, K, Lambda_d, full_d);
+  REQUIRE(full_p.cols() == K * K);
+  for (int i = 0; i < nrows; i++)
+    for (int c = 0; c < K; c++)
+      for (int j = 0; j < K; j++)
+      {
+        const int p = std::max(c, j) * (std::max(c, j) + 1) / 2 + std::min(c, j);
+        REQUIRE(full_p(i, c * K + j) == Lambda_p(i, p));
+        REQUIRE(full_d(i, c * K + j) == (c == j ? Lambda_d(i, c) : 0.0));
+      }
+}
+
+TEST_CASE( "Model/Aggregate_rank_deficient", "Test if rank deficient sample covariances are saved as singular") {
+  const int nrows = 100, K = 16;
+
+  // nsamples == K: the samples span at most K - 1 dimensions
+  Aggregate packed(AggregateTypes::packed, nrows, K);
+  Aggregate spill(AggregateTypes::spill, nrows, K, "test_aggregate_rank.spill");
+  for (int s = 0; s < K; s++)
+  {
+    const Matrix U = Matrix::Random(nrows, K);
+    packed.add(U);
+    spill.add(U);
+  }
+
+  Matrix mu(nrows, K), Lambda(nrows, K * (K + 1) / 2);
+  int first;
+  REQUIRE(packed.post(0, mu, Lambda, first) == nrows);
+  REQUIRE(first == 0);
+  REQUIRE(Lambda.isZero());
+  REQUIRE(spill.post(0, mu, Lambda, first) == nrows);
+  REQUIRE(Lambda.isZero());
+
+  // more samples than latents, but latent 3 is a combination of latents 0 and 1,
+  // which rounding does not make exactly singular
+  Aggregate dependent(AggregateTypes::packed, nrows, K);
+  for (int s = 0; s < 4 * K; s++)
+  {
+    Matrix U = Matrix::Random(nrows, K);
+    U.col(3) = 0.1 * U.col(0) + 0.3 * U.col(1);
+    dependent.add(U);
+  }
+  REQUIRE(dependent.post(0, mu, Lambda, first) == nrows);
+  REQUIRE(Lambda.isZero());
+}
+
 TEST_CASE( "utils/eval_rmse", "Test if prediction variance is correctly calculated")
 {
   std::vector<std::uint32_t> rows = {0};
@@ -160,6 +577,163 @@ TEST_CASE( "ScarceMatrixData/var_total", "Test if variance of Scarce Matrix is c
   REQUIRE(data->var_total() == Approx(0.25));
 }
 
+TEST_CASE( "ScarceMatrixData/getMuLambda", "Test if blocked and rank-1 kernels give the same rr and MM") {
+  // row 0 is long enough for the gather-and-SYRK kernel, row 1 uses rank-1 updates
+  std::vector<std::uint32_t> rows, cols;
+  std::vector<double> vals;
+  for (std::uint32_t c = 0; c < 40; c++) { rows.push_back(0); cols.push_back(c); vals.push_back(0.1 * c - 1.); }
+  for (std::uint32_t c = 0; c < 40; c += 8) { rows.push_back(1); cols.push_back(c); vals.push_back(0.2 * c); }
+
+  const SparseMatrix S = matrix_utils::sparse_to_eigen(SparseTensor( {2, 40}, { rows, cols }, vals));
+  std::shared_ptr<Data> data(new ScarceMatrixData(S));
+  data->setNoiseModel(NoiseFactory::create_noise_model(fixed_ncfg));
+  data->init();
+
+  init_bmrng(1234);
+  Model model;
+  model.init(3, PVec<>({2, 40}), ModelInitTypes::random, false);
+  const double alpha = data->noise().getAlpha();
+
+  for (int n = 0; n < 2; n++)
+  {
+    Vector rr = Vector::Zero(3);
+    Matrix MM = Matrix::Zero(3, 3);
+    data->getMuLambda(model.full(), 0, n, rr, MM);
+
+    Vector rr_true = Vector::Zero(3);
+    Matrix MM_true = Matrix::Zero(3, 3);
+    for (SparseMatrix::InnerIterator it(S, n); it; ++it)
+    {
+      rr_true += alpha * it.value() * model.U(1).row(it.col());
+      MM_true += alpha * model.U(1).row(it.col()).transpose() * model.U(1).row(it.col());
+    }
+
+    for (int i = 0; i < 3; i++)
+    {
+      REQUIRE(rr(i) == Approx(rr_true(i)));
+      for (int j = 0; j < 3; j++)
+        REQUIRE(MM(i, j) == Approx(MM_true(i, j)));
+    }
+  }
+}
+
+TEST_CASE( "SparseMatrixData/sumsq", "Test if closed-form sumsq of fully known Sparse Matrix equals the sum over all cells") {
+  std::vector<std::uint32_t> rows = {0, 0, 1, 3, 4, 4};
+  std::vector<std::uint32_t> cols = {0, 2, 1, 5, 0, 3};
+  std::vector<double>        vals = {1., -2., 3., 0.5, 4., -1.5};
+
+  const SparseMatrix S = matrix_utils::sparse_to_eigen(SparseTensor( {5, 6}, { rows, cols }, vals));
+  std::shared_ptr<Data> data(new SparseMatrixData(S));
+  data->setNoiseModel(NoiseFactory::create_noise_model(fixed_ncfg));
+  data->init();
+
+  init_bmrng(1234);
+  Model model;
+  model.init(3, PVec<>({5, 6}), ModelInitTypes::random, false);
+
+  double sumsq_true = 0.0;
+  for (int r = 0; r < S.rows(); r++)
+    for (int c = 0; c < S.cols(); c++)
+      sumsq_true += std::pow(model.predict({r, c}) - S.coeff(r, c), 2);
+
+  REQUIRE(data->sumsq(model.full()) == Approx(sumsq_true));
+
+  // with cached U(0)^T * U(0)
+  data->update_pnm(model.full(), 1);
+  REQUIRE(data->sumsq(model.full()) == Approx(sumsq_true));
+  REQUIRE(data->train_rmse(model.full()) == Approx(std::sqrt(sumsq_true / 30)));
+
+  // the cache is stale once mode 0 is sampled again
+  data->update_pnm(model.full(), 0);
+  model.U(0).setRandom();
+  sumsq_true = 0.0;
+  for (int r = 0; r < S.rows(); r++)
+    for (int c = 0; c < S.cols(); c++)
+      sumsq_true += std::pow(model.predict({r, c}) - S.coeff(r, c), 2);
+
+  REQUIRE(data->sumsq(model.full()) == Approx(sumsq_true));
+}
+
+TEST_CASE( "Data/sumsq_row", "Test if the row residuals of the last mode add up to sumsq") {
+  std::vector<std::uint32_t> rows = {0, 0, 1, 3, 4, 4};
+  std::vector<std::uint32_t> cols = {0, 2, 1, 5, 0, 3};
+  std::vector<double>        vals = {1., -2., 3., 0.5, 4., -1.5};
+  const SparseMatrix S = matrix_utils::sparse_to_eigen(SparseTensor( {5, 6}, { rows, cols }, vals));
+
+  std::vector<std::shared_ptr<Data>> datas = {
+    std::shared_ptr<Data>(new ScarceMatrixData(S)),
+    std::shared_ptr<Data>(new SparseMatrixData(S)),
+    std::shared_ptr<Data>(new DenseMatrixData(Matrix(S))),
+  };
+
+  init_bmrng(1234);
+  Model model;
+  model.init(3, PVec<>({5, 6}), ModelInitTypes::random, false);
+
+  for (auto &data : datas)
+  {
+    data->setNoiseModel(NoiseFactory::create_noise_model(fixed_ncfg));
+    data->init();
+    data->update_pnm(model.full(), 1);
+
+    double sumsq = 0.0;
+    for (int d = 0; d < 6; d++)
+      sumsq += data->sumsq_row(model.full(), 1, d);
+
+    REQUIRE(sumsq == Approx(data->sumsq(model.full())));
+  }
+}
+
+TEST_CASE( "BinaryMatrixData/getMuLambda", "Test if the value-free kernels match SparseMatrixData with all non-zeros 1") {
+  std::vector<std::uint32_t> rows = {0, 0, 1, 3, 4, 4, 2};
+  std::vector<std::uint32_t> cols = {0, 2, 1, 5, 0, 3, 5};
+  std::vector<double>        vals = {1., -2., 3., 0.5, 4., -1.5, 2.};
+  const SparseMatrix S = matrix_utils::sparse_to_eigen(SparseTensor( {5, 6}, { rows, cols }, vals));
+  const SparseMatrix ones = matrix_utils::sparse_to_eigen(SparseTensor( {5, 6}, { rows, cols }, std::vector<double>(vals.size(), 1.)));
+
+  std::shared_ptr<Data> binary(new BinaryMatrixData(S)); // values are ignored
+  std::shared_ptr<Data> sparse(new SparseMatrixData(ones));
+
+  init_bmrng(1234);
+  Model model;
+  model.init(3, PVec<>({5, 6}), ModelInitTypes::random, false);
+
+  for (auto &data : { binary, sparse })
+  {
+    data->setNoiseModel(NoiseFactory::create_noise_model(fixed_ncfg));
+    data->init();
+  }
+
+  REQUIRE(binary->nnz() == sparse->nnz());
+  REQUIRE(binary->sum() == Approx(sparse->sum()));
+  REQUIRE(binary->var_total() == Approx(sparse->var_total()));
+
+  for (int mode = 0; mode < 2; mode++)
+  {
+    binary->update_pnm(model.full(), mode);
+    sparse->update_pnm(model.full(), mode);
+
+    for (int d = 0; d < model.U(mode).rows(); d++)
+    {
+      Vector rr = Vector::Zero(3), rr_true = Vector::Zero(3);
+      Matrix MM = Matrix::Zero(3, 3), MM_true = Matrix::Zero(3, 3);
+      binary->getMuLambda(model.full(), mode, d, rr, MM);
+      sparse->getMuLambda(model.full(), mode, d, rr_true, MM_true);
+
+      for (int i = 0; i < 3; i++)
+      {
+        REQUIRE(rr(i) == Approx(rr_true(i)));
+        for (int j = 0; j < 3; j++)
+          REQUIRE(MM(i, j) == Approx(MM_true(i, j)));
+      }
+
+      REQUIRE(binary->sumsq_row(model.full(), mode, d) == Approx(sparse->sumsq_row(model.full(), mode, d)));
+    }
+  }
+
+  REQUIRE(binary->sumsq(model.full()) == Approx(sparse->sumsq(model.full())));
+}
+
 TEST_CASE( "DenseMatrixData/var_total", "Test if variance of Dense Matrix is correctly calculated") {
   Matrix Y(2, 2);
   Y << 1., 2., 3., 4.;
@@ -172,6 +746,85 @@ TEST_CASE( "DenseMatrixData/var_total", "Test if variance of Dense Matrix is cor
   REQUIRE(data->var_total() == Approx(1.25));
 }
 
+TEST_CASE( "DenseMatrixData/getMuLambda", "Test if GEMM-based rr, MM and sumsq equal the per-cell sums") {
+  Matrix Y(4, 5);
+  Y << 1.,  2., -1., 0.5, 3.,
+       0., -2.,  4., 1.5, 1.,
+       2.,  1.,  1., -3., 0.,
+      -1.,  0.,  2.,  2., 5.;
+
+  std::shared_ptr<Data> data(new DenseMatrixData(Y));
+  data->setNoiseModel(NoiseFactory::create_noise_model(fixed_ncfg));
+  data->init();
+
+  init_bmrng(1234);
+  Model model;
+  model.init(3, PVec<>({4, 5}), ModelInitTypes::random, false);
+
+  const double alpha = data->noise().getAlpha();
+  for (int mode = 0; mode < 2; mode++)
+  {
+    const Matrix Ym = mode == 0 ? Y : Matrix(Y.transpose());
+    const auto &V = model.U(1 - mode);
+    data->update_pnm(model.full(), mode);
+
+    for (int d = 0; d < Ym.rows(); d++)
+    {
+      Vector rr = Vector::Zero(3);
+      Matrix MM = Matrix::Zero(3, 3);
+      data->getMuLambda(model.full(), mode, d, rr, MM);
+
+      Vector rr_true = Vector::Zero(3);
+      for (int r = 0; r < Ym.cols(); r++)
+        rr_true += V.row(r) * Ym(d, r) * alpha;
+      Matrix MM_true = alpha * V.transpose() * V;
+
+      for (int i = 0; i < 3; i++)
+      {
+        REQUIRE(rr(i) == Approx(rr_true(i)));
+        for (int j = 0; j < 3; j++)
+          REQUIRE(MM(i, j) == Approx(MM_true(i, j)));
+      }
+    }
+  }
+
+  double sumsq_true = 0.0;
+  for (int r = 0; r < Y.rows(); r++)
+    for (int c = 0; c < Y.cols(); c++)
+      sumsq_true += std::pow(model.predict({r, c}) - Y(r, c), 2);
+
+  REQUIRE(data->sumsq(model.full()) == Approx(sumsq_true));
+}
+
+TEST_CASE( "DualSparseMatrix/modes", "Test if both modes of the single-copy sparse matrix match Y and its transpose") {
+  std::vector<Eigen::Triplet<float_type>> triplets = {
+    {0, 1, 1.}, {0, 3, 2.}, {1, 0, 3.}, {2, 1, 4.}, {2, 2, 5.}, {2, 3, 6.}, {3, 3, 7.}
+  };
+  SparseMatrix Y(4, 5);
+  Y.setFromTriplets(triplets.begin(), triplets.end());
+  const SparseMatrix Yt = Y.transpose();
+
+  DualSparseMatrix dual(Y);
+  REQUIRE(dual.nonZeros() == Y.nonZeros());
+
+  for (int mode = 0; mode < 2; mode++)
+  {
+    const SparseMatrix &Ym = mode == 0 ? Y : Yt;
+    REQUIRE(dual.nouter(mode) == Ym.rows());
+    for (int n = 0; n < Ym.rows(); n++)
+    {
+      DualSparseMatrix::ModeIterator it(dual, mode, n);
+      for (SparseMatrix::InnerIterator it_true(Ym, n); it_true; ++it_true, ++it)
+      {
+        REQUIRE(it);
+        REQUIRE(it.index() == it_true.col());
+        REQUIRE(it.value() == it_true.value());
+      }
+      REQUIRE(!it);
+    }
+  }
+}
+
 using namespace Eigen;
 using namespace std;
 
@@ -189,6 +842,42 @@ TEST_CASE("truncnorm/norm_cdf", "Normal CDF") {
 	REQUIRE( norm_cdf(4.0)  == Approx(0.99996832875816688) );
 }
 
+TEST_CASE("inv_norm_cdf/approx_inv_norm_cdf", "Vectorized inverse normal CDF") {
+  std::vector<double> ys;
+  for (int e = -300; e < -1; e++) { ys.push_back(std::pow(10., e)); ys.push_back(1. - std::pow(10., e / 20.)); }
+  for (int i = 1; i < 1000; i++) ys.push_back(i / 1000.);
+
+  const Array1D y = Eigen::Map<Eigen::Array<double, 1, Eigen::Dynamic>>(ys.data(), ys.size()).cast<float_type>();
+  const Array1D x = approx_inv_norm_cdf(y);
+  for (int i = 0; i < y.size(); i++)
+    REQUIRE( std::abs(x(i) - inv_norm_cdf(y(i))) <= 1.2e-9 * std::max(1., std::abs(inv_norm_cdf(y(i)))) );
+}
+
+TEST_CASE("truncnorm/approx_norm_cdf", "Vectorized normal CDF") {
+  const Array1D x = Array1D::LinSpaced(1601, -8., 8.);
+  const Array1D p = approx_norm_cdf(x);
+  for (int i = 0; i < x.size(); i++)
+    REQUIRE( std::abs(p(i) - norm_cdf(x(i))) <= 1.2e-7 * norm_cdf(x(i)) );
+}
+
+TEST_CASE( "truncnorm/rand_truncnorm_batch", "generating a batch of random truncnorm variables" ) {
+  init_bmrng(1234);
+  Array1D low_cut(6);
+  low_cut << -2., 0., 1., 2.5, 3.5, 50.;
+
+  const int n = 2000;
+  Array1D sum = Array1D::Zero(6);
+  for (int i = 0; i < n; i++) {
+    Array1D x;
+    rand_truncnorm(low_cut, x);
+    REQUIRE( (x >= low_cut).all() );
+    sum += x;
+  }
+
+  // mean of N(0, 1) truncated at 0 is sqrt(2 / pi)
+  REQUIRE( sum(1) / n == Approx(std::sqrt(2. / M_PI)).epsilon(0.05) );
+}
+
 TEST_CASE( "truncnorm/rand_truncnorm", "generaring random truncnorm variable" ) {
   init_bmrng(1234);
   for (int i = 0; i < 10; i++) {
@@ -71,8 +71,8 @@ class SampledNoise(NoiseConfig):
         NoiseConfig.__init__(self, "sampled", precision)
 
 class AdaptiveNoise(NoiseConfig):
-    def __init__(self, sn_init = 5.0, sn_max = 10.0): 
-        NoiseConfig.__init__(self, "adaptive", sn_init = sn_init, sn_max = sn_max)
+    def __init__(self, sn_init = 5.0, sn_max = 10.0, fused_sumsq = False): 
+        NoiseConfig.__init__(self, "adaptive", sn_init = sn_init, sn_max = sn_max, fused_sumsq = fused_sumsq)
 
 class ProbitNoise(NoiseConfig):
     def __init__(self, threshold = 0.): 
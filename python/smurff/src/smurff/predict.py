@@ -43,8 +43,23 @@ class Sample:
     def postMuLambda(self, mode):
         mu = self.lookup_mode("latents/post_mu_%d", mode)
         Lambda = self.lookup_mode("latents/post_lambda_%d", mode)
-        assert Lambda.shape[1] == self.num_latent * self.num_latent
-        Lambda = Lambda.reshape(Lambda.shape[0], self.num_latent, self.num_latent)
+        K = self.num_latent
+        if Lambda.shape[1] == K * K:
+            Lambda = Lambda.reshape(Lambda.shape[0], K, K)
+        elif Lambda.shape[1] == K * (K + 1) // 2:
+            # packed lower triangle, row by row, as saved by some earlier versions
+            packed = Lambda
+            Lambda = np.zeros((packed.shape[0], K, K), dtype=packed.dtype)
+            rows, cols = np.tril_indices(K)
+            Lambda[:, rows, cols] = packed
+            Lambda[:, cols, rows] = packed
+        elif Lambda.shape[1] == K:
+            # diagonal only, as saved by some earlier versions
+            diag = Lambda
+            Lambda = np.zeros((diag.shape[0], K, K), dtype=diag.dtype)
+            Lambda[:, np.arange(K), np.arange(K)] = diag
+        else:
+            assert False, "unexpected shape of post_lambda_%d" % mode
 
         return mu, Lambda
 
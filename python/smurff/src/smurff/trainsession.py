@@ -52,6 +52,13 @@ class TrainSession(PythonSession):
     checkpoint_freq: int
         Save the state of the trainSession every N seconds.
 
+    aggregate: { "packed", "diagonal", "spill", "none" }
+        How the posterior mean and precision of the latents are collected:
+        the lower triangle of the precision ("packed"), only its diagonal
+        ("diagonal"), "packed" but kept on disk next to `save_name`
+        ("spill"), or not at all ("none"). Unless "none", `post_lambda`
+        is saved with the full K x K precision of every row.
+
     """
     #
     # construction functions
@@ -68,6 +75,7 @@ class TrainSession(PythonSession):
         save_name        = None,
         save_freq        = None,
         checkpoint_freq  = None,
+        aggregate        = None,
         ):
 
         super().__init__()
@@ -83,15 +91,16 @@ class TrainSession(PythonSession):
         if save_name is not None:       self.setSaveName(save_name)
         if save_freq is not None:       self.setSaveFreq(save_freq)
         if checkpoint_freq is not None: self.setCheckpointFreq(checkpoint_freq)
+        if aggregate is not None:       self.setAggregateType(aggregate)
 
 
-    def addTrainAndTest(self, Y, Ytest = None, noise = FixedNoise(), is_scarce = True):
-        self.setTrain(Y, noise, is_scarce)
+    def addTrainAndTest(self, Y, Ytest = None, noise = FixedNoise(), is_scarce = True, is_binary = False):
+        self.setTrain(Y, noise, is_scarce, is_binary)
 
         if Ytest is not None:
             self.setTest(Ytest)
 
-    def setTrain(self, Y, noise = FixedNoise(), is_scarce = True):
+    def setTrain(self, Y, noise = FixedNoise(), is_scarce = True, is_binary = False):
         """Adds a train and optionally a test matrix as input data to this TrainSession
 
         Parameters
@@ -108,11 +117,16 @@ class TrainSession(PythonSession):
             When `Y` is sparse, and `is_scarce` is *False* the missing values are considered as *zero*.
             When `Y` is dense, this parameter is ignored.
 
+        is_binary : bool
+            When `Y` is sparse and `is_binary` is *True* only the pattern of `Y` is kept:
+            the stored values are considered as *one*, the missing values as *zero*.
+            Requires `is_scarce` to be *False*.
+
         """
         
-        super().setTrain(Y, noise, is_scarce)
+        super().setTrain(Y, noise, is_scarce, is_binary)
        
-    def addSideInfo(self, mode, Y, noise = SampledNoise(), direct = True):
+    def addSideInfo(self, mode, Y, noise = SampledNoise(), direct = True, preconditioner = "jacobi", sparse_direct = False):
         """Adds fully known side info, for use in with the macau or macauone prior
 
         mode : int
@@ -132,8 +146,16 @@ class TrainSession(PythonSession):
 
             The direct method is only feasible for a small (< 100K) number of features.
 
+        preconditioner : { "jacobi", "block_jacobi", "none" }
+            Preconditioner of the CG solver, when `direct` is False.
+
+        sparse_direct : boolean
+            When True, the direct method factors F'F as a sparse matrix, keeping the
+            symbolic analysis between samples. Only for sparse side info,
+            where F'F is sparse as well.
+
         """
-        super().addSideInfo(mode, Y, noise, direct)
+        super().addSideInfo(mode, Y, noise, direct, preconditioner, sparse_direct)
 
     def addPropagatedPosterior(self, mode, mu, Lambda):
         """Adds mu and Lambda from propagated posterior
@@ -159,7 +181,7 @@ class TrainSession(PythonSession):
         self.addPropagatedPosterior(mode, mu, Lambda)
 
 
-    def addData(self, pos, Y, noise = FixedNoise(), is_scarce = False):
+    def addData(self, pos, Y, noise = FixedNoise(), is_scarce = False, is_binary = False):
         """Stacks more matrices/tensors next to the main train matrix.
 
         pos : shape
@@ -174,6 +196,11 @@ class TrainSession(PythonSession):
             When `Y` is sparse, and `is_scarce` is *False* the missing values are considered as *zero*.
             When `Y` is dense, this parameter is ignored.
 
+        is_binary : bool
+            When `Y` is sparse and `is_binary` is *True* only the pattern of `Y` is kept:
+            the stored values are considered as *one*, the missing values as *zero*.
+            Requires `is_scarce` to be *False*.
+
         noise : :class: `NoiseConfig`
             Noise model to use for `Y`
         
@@ -183,10 +210,10 @@ class TrainSession(PythonSession):
             super().addData(pos, Y, noise)
         elif sp.issparse(Y):
             # sparse/scarce scipy.sparse matrix
-            super().addData(pos, Y.tocsr(), noise, is_scarce)
+            super().addData(pos, Y.tocsr(), noise, is_scarce, is_binary)
         elif isinstance(Y, SparseTensor):
             # sparse/scarce scipy.sparse tensor
-            super().addData(pos, Y, noise, is_scarce)
+            super().addData(pos, Y, noise, is_scarce, is_binary)
         else:
             raise TypeError("Unsupported type for addData: {}. We support numpy.ndarray, scipy.sparce matrix or SparseTensora.".format(Y))
 
@@ -25,12 +25,13 @@ PYBIND11_MODULE(wrapper, m)
     m.attr("version") = SMURFF_VERSION;
 
     py::class_<smurff::NoiseConfig>(m, "NoiseConfig")
-        .def(py::init<const std::string, double, double, double, double>(),
+        .def(py::init<const std::string, double, double, double, double, bool>(),
            py::arg("noise_type") = "fixed",
            py::arg("precision") = 5.0,
            py::arg("sn_init") = 1.0,
            py::arg("sn_max") = 10.0,
-           py::arg("threshold") = 0.5
+           py::arg("threshold") = 0.5,
+           py::arg("fused_sumsq") = false
         )  
         ;
 
@@ -85,6 +86,7 @@ PYBIND11_MODULE(wrapper, m)
         .def("setSaveName", &smurff::PythonSession::setSaveName)
         .def("setSaveFreq", &smurff::PythonSession::setSaveFreq)
         .def("setCheckpointFreq", &smurff::PythonSession::setCheckpointFreq)
+        .def("setAggregateType", &smurff::PythonSession::setAggregateType)
         .def("setRandomSeed", &smurff::PythonSession::setRandomSeed)
         .def("setVerbose", &smurff::PythonSession::setVerbose)
         .def("setBurnin", &smurff::PythonSession::setBurnin)
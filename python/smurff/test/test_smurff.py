@@ -35,6 +35,19 @@ class TestSmurff(unittest.TestCase):
                       nsamples=15,
                       verbose=False)
 
+    def test_bpmf_binary(self):
+        Y = scipy.sparse.rand(15, 10, 0.2).tocsr()
+        Y.data[:] = 1
+        Ytest = scipy.sparse.rand(15, 10, 0.1).tocsr()
+        trainSession = smurff.TrainSession(priors=['normal', 'normal'],
+                                           num_latent=4,
+                                           burnin=10,
+                                           nsamples=10,
+                                           verbose=False)
+        trainSession.addTrainAndTest(Y, Ytest, is_scarce=False, is_binary=True)
+        predictions = trainSession.run()
+        self.assertEqual(Ytest.nnz, len(predictions))
+
     def test_macau(self):
         Ydense  = np.random.rand(10, 20)
         r       = np.random.permutation(10*20)[:40] # 40 random samples from 10*20 matrix